@@ -0,0 +1,78 @@
+#include <time.h>
+#include "utils.h"
+#include "gb.h"
+#include "cpu.h"
+#include <SDL2/SDL.h>
+
+// Compare polling the keyboard after every instruction with polling it
+// once per frame. Runs the ROM headless with the dummy SDL video driver.
+// Both run the core in the same short chunks, about an instruction each,
+// so only the number of polls differs.
+
+#define FRAMES 600
+#define CHUNK_CYCLES 2
+
+static double cpu_seconds(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void poll_keyboard(GbContext *gb)
+{
+  const Uint8 *state = SDL_GetKeyboardState(NULL);
+  uint8_t joypad = 0xFF;
+  if (state[SDL_SCANCODE_RIGHT]) joypad &= ~(1 << 0);
+  if (state[SDL_SCANCODE_LEFT]) joypad &= ~(1 << 1);
+  if (state[SDL_SCANCODE_UP]) joypad &= ~(1 << 2);
+  if (state[SDL_SCANCODE_DOWN]) joypad &= ~(1 << 3);
+  if (state[SDL_SCANCODE_A]) joypad &= ~(1 << 4);
+  if (state[SDL_SCANCODE_S]) joypad &= ~(1 << 5);
+  if (state[SDL_SCANCODE_SPACE]) joypad &= ~(1 << 6);
+  if (state[SDL_SCANCODE_RETURN]) joypad &= ~(1 << 7);
+  joypad_set(gb, joypad);
+}
+
+static double run(GbContext *gb, int per_instruction)
+{
+  if (init(gb))
+    exit(1);
+  double start = cpu_seconds();
+
+  for (int frame = 0; frame < FRAMES; frame++)
+  {
+    int done = 0;
+    while (!done)
+    {
+      cpu_run(gb, gb->framebuffer, &done, CHUNK_CYCLES);
+      if (per_instruction)
+        poll_keyboard(gb);
+    }
+    if (!per_instruction)
+      poll_keyboard(gb);
+  }
+
+  return cpu_seconds() - start;
+}
+
+int main(int argc, char *args[])
+{
+  GbContext *gb = context_new();
+
+  gb->mmu.path_rom = argc > 1 ? args[1] : "misc/Tetris.gb";
+  setenv("SDL_VIDEODRIVER", "dummy", 1);
+  SDL_Init(SDL_INIT_VIDEO);
+  pacer_set_speed(&gb->pacer, PACER_UNLIMITED);
+
+  double instruction = run(gb, 1);
+  double frame = run(gb, 0);
+
+  printf("poll per instruction: %.3fs for %d frames (%.0f fps)\n", instruction, FRAMES, FRAMES / instruction);
+  printf("poll per frame:       %.3fs for %d frames (%.0f fps)\n", frame, FRAMES, FRAMES / frame);
+  printf("speedup: %.2fx\n", instruction / frame);
+
+  SDL_Quit();
+  context_free(gb);
+  return 0;
+}
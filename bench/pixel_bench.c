@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "pixel.h"
+
+// Check every pixel kernel against the scalar one on all plane pairs, then
+// time each of them expanding a 256x256 background's worth of rows.
+
+#define ROUNDS 2000
+
+static double cpu_seconds(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int check(const Pixel_kernel *kernel, const uint32_t lut[4])
+{
+  const Pixel_kernel *scalar = &pixel_kernels[0];
+  for (int planes = 0; planes < 0x10000; planes++)
+  {
+    uint8_t want[32], got[32];
+    uint8_t lo = planes & 0xFF;
+    uint8_t hi = planes >> 8;
+
+    scalar->expand(lo, hi, lut, want);
+    kernel->expand(lo, hi, lut, got);
+    if (memcmp(want, got, 32))
+      return 0;
+
+    memset(want, planes, 32);
+    memset(got, planes, 32);
+    scalar->expand_masked(lo, hi, lut, want);
+    kernel->expand_masked(lo, hi, lut, got);
+    if (memcmp(want, got, 32))
+      return 0;
+  }
+  return 1;
+}
+
+static double run(Pixel_expand expand, const uint32_t lut[4], const uint8_t tiles[], uint8_t plane[])
+{
+  double start = cpu_seconds();
+  for (int round = 0; round < ROUNDS; round++)
+    for (int row = 0; row < 256 * 32; row++)
+      expand(tiles[row * 2], tiles[row * 2 + 1], lut, &plane[row * 32]);
+  return cpu_seconds() - start;
+}
+
+int main(void)
+{
+  static uint8_t tiles[256 * 32 * 2];
+  static uint8_t plane[256 * 256 * 4];
+  const uint32_t lut[4] = {
+    pixel_argb(255, 255, 255, 255), pixel_argb(255, 0xCC, 0xCC, 0xCC),
+    pixel_argb(255, 0x77, 0x77, 0x77), 0
+  };
+
+  for (unsigned i = 0; i < sizeof(tiles); i++)
+    tiles[i] = (i * 2654435761u) >> 24;
+
+  printf("best kernel here: %s\n", pixel_kernel()->name);
+  for (const Pixel_kernel *kernel = pixel_kernels; kernel->name; kernel++)
+  {
+    if (!pixel_kernel_supported(kernel))
+    {
+      printf("%-8s not supported by this CPU\n", kernel->name);
+      continue;
+    }
+    if (!check(kernel, lut))
+    {
+      printf("%-8s differs from scalar\n", kernel->name);
+      return 1;
+    }
+
+    double expand = run(kernel->expand, lut, tiles, plane);
+    double masked = run(kernel->expand_masked, lut, tiles, plane);
+    double rows = (double)ROUNDS * 256 * 32;
+    printf("%-8s expand %.2f ns/row, masked %.2f ns/row\n", kernel->name,
+           expand / rows * 1e9, masked / rows * 1e9);
+  }
+  return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef CONTEXT_H
+# define CONTEXT_H
+
+#include <time.h>
+#include "registers.h"
+#include "mmu.h"
+#include "scheduler.h"
+#include "pacer.h"
+#include "vram.h"
+
+// Blocks the host for about `ns` nanoseconds, or less if input arrives
+typedef void (*Idle_handler)(GbContext *gb, uint64_t ns);
+
+// Everything a single Game Boy owns. Nothing in the core is global, so any
+// number of machines can run in one process, each one on its own thread.
+struct GbContext
+{
+  Registers r;
+  My_clock clock;
+  Mmu mmu;
+  Scheduler scheduler;
+  TileCache tiles;
+  BgCache bg;
+  Palettes palettes;
+  uint8_t *framebuffer;  // SCREEN_WIDTH x SCREEN_HEIGHT, see vram.h
+  uint8_t *shades;
+
+  // Host side pacing and reports, see pacer.c and utils.c
+  Pacer pacer;
+  Idle_handler idle_handler;
+  int cpu_report;
+  uint64_t report_cycles;
+  struct timespec report_cpu;
+  struct timespec report_wall;
+};
+
+GbContext *context_new(void);
+void context_free(GbContext *gb);
+
+#endif /* CONTEXT_H */
@@ -0,0 +1,10 @@
+#ifndef CPU_H
+# define CPU_H
+
+#include "utils.h"
+
+// Run the interpreter core until a frame is completed (*display set) or
+// at least `cycles` m-cycles have elapsed. Returns the m-cycles executed.
+uint32_t cpu_run(GbContext *gb, uint8_t pixels[], int *display, uint32_t cycles);
+
+#endif /* CPU_H */
@@ -0,0 +1,342 @@
+// Interpreter loop, included by cpu.c once per memory bus. CORE_RUN is the
+// name of the generated function and CORE_WRITE the bus write it uses, so
+// no mapper is checked inside the loop. It returns when a frame is done,
+// at the end of the run or when the BIOS gets unmapped, with the mask of
+// the events that stopped it.
+
+static int CORE_RUN(GbContext *gb, uint8_t pixels[], int *display)
+{
+  uint8_t a = gb->r.AF.bytes.high, f = gb->r.AF.bytes.low;
+  uint8_t b = gb->r.BC.bytes.high, c = gb->r.BC.bytes.low;
+  uint8_t d = gb->r.DE.bytes.high, e = gb->r.DE.bytes.low;
+  uint8_t h = gb->r.HL.bytes.high, l = gb->r.HL.bytes.low;
+  uint16_t sp = gb->r.SP.val;
+  uint16_t pc = gb->r.PC.val;
+  uint8_t ime = gb->r.ime;
+  int events;
+
+  while (1)
+  {
+    uint32_t m = 1;
+
+    if (!gb->mmu.HALT)
+    {
+      uint8_t op = FETCH();
+      switch (op)
+      {
+        case 0x00: m = 1; break;
+        case 0x01: SET_BC(FETCH16()); m = 3; break;
+        case 0x02: CORE_WRITE(gb, REG_BC, a); m = 1; break;
+        case 0x03: SET_BC(REG_BC + 1); m = 1; break;
+        case 0x04: INC8(b); m = 1; break;
+        case 0x05: DEC8(b); m = 1; break;
+        case 0x06: b = FETCH(); m = 2; break;
+        case 0x07: f = (a > 0x7F) ? FLAG_C : 0; a = (a << 1) | (a >> 7); m = 1; break;
+        case 0x08:
+        {
+          uint16_t addr = FETCH16();
+          CORE_WRITE(gb, addr, sp & 0xFF);
+          CORE_WRITE(gb, addr + 1, sp >> 8);
+          m = 3;
+          break;
+        }
+        case 0x09: ADD16(REG_BC); m = 1; break;
+        case 0x0A: a = bus_read(gb, REG_BC); m = 1; break;
+        case 0x0B: SET_BC(REG_BC - 1); m = 1; break;
+        case 0x0C: INC8(c); m = 1; break;
+        case 0x0D: DEC8(c); m = 1; break;
+        case 0x0E: c = FETCH(); m = 2; break;
+        case 0x0F: a = (a >> 1) | ((a & 1) << 7); f = (a > 0x7F) ? FLAG_C : 0; m = 1; break;
+
+        case 0x10:
+          // Test for speed switch
+          if (!test_bit(gb->mmu.memory[0xFF4D], 0))
+          {
+            printf("Stop, exit...");
+            exit(1);
+          }
+          m = 1;
+          break;
+        case 0x11: SET_DE(FETCH16()); m = 3; break;
+        case 0x12: CORE_WRITE(gb, REG_DE, a); m = 1; break;
+        case 0x13: SET_DE(REG_DE + 1); m = 1; break;
+        case 0x14: INC8(d); m = 1; break;
+        case 0x15: DEC8(d); m = 1; break;
+        case 0x16: d = FETCH(); m = 2; break;
+        case 0x17:
+        {
+          uint8_t carry = (f & FLAG_C) ? 1 : 0;
+          f = (a > 0x7F) ? FLAG_C : 0;
+          a = (a << 1) | carry;
+          m = 1;
+          break;
+        }
+        case 0x18: JR(1); break;
+        case 0x19: ADD16(REG_DE); m = 1; break;
+        case 0x1A: a = bus_read(gb, REG_DE); m = 1; break;
+        case 0x1B: SET_DE(REG_DE - 1); m = 1; break;
+        case 0x1C: INC8(e); m = 1; break;
+        case 0x1D: DEC8(e); m = 1; break;
+        case 0x1E: e = FETCH(); m = 2; break;
+        case 0x1F:
+        {
+          uint8_t carry = (f & FLAG_C) ? 0x80 : 0;
+          f = (a & 1) ? FLAG_C : 0;
+          a = (a >> 1) | carry;
+          m = 1;
+          break;
+        }
+
+        case 0x20: JR(!(f & FLAG_Z)); break;
+        case 0x21: SET_HL(FETCH16()); m = 3; break;
+        case 0x22: CORE_WRITE(gb, REG_HL, a); SET_HL(REG_HL + 1); m = 1; break;
+        case 0x23: SET_HL(REG_HL + 1); m = 1; break;
+        case 0x24: INC8(h); m = 1; break;
+        case 0x25: DEC8(h); m = 1; break;
+        case 0x26: h = FETCH(); m = 2; break;
+        case 0x27: // DAA
+          if (!(f & FLAG_N))
+          {
+            if ((f & FLAG_C) || (a > 0x99))
+            {
+              a += 0x60;
+              f |= FLAG_C;
+            }
+            if ((f & FLAG_H) || ((a & 0x0F) > 0x09))
+              a += 0x6;
+          }
+          else
+          {
+            if (f & FLAG_C)
+              a -= 0x60;
+            if (f & FLAG_H)
+              a -= 0x6;
+          }
+          f = (f & (FLAG_N | FLAG_C)) | (a ? 0 : FLAG_Z);
+          m = 1;
+          break;
+        case 0x28: JR(f & FLAG_Z); break;
+        case 0x29: ADD16(REG_HL); m = 1; break;
+        case 0x2A: a = bus_read(gb, REG_HL); SET_HL(REG_HL + 1); m = 1; break;
+        case 0x2B: SET_HL(REG_HL - 1); m = 1; break;
+        case 0x2C: INC8(l); m = 1; break;
+        case 0x2D: DEC8(l); m = 1; break;
+        case 0x2E: l = FETCH(); m = 2; break;
+        case 0x2F: a ^= 0xFF; f |= FLAG_N | FLAG_H; m = 1; break;
+
+        case 0x30: JR(!(f & FLAG_C)); break;
+        case 0x31: sp = FETCH16(); m = 3; break;
+        case 0x32: CORE_WRITE(gb, REG_HL, a); SET_HL(REG_HL - 1); m = 1; break;
+        case 0x33: sp++; m = 1; break;
+        case 0x34:
+        {
+          uint8_t old = bus_read(gb, REG_HL);
+          CORE_WRITE(gb, REG_HL, old + 1);
+          uint8_t res = bus_read(gb, REG_HL);
+          f = (f & FLAG_C) | (res ? 0 : FLAG_Z) | (((res ^ 0x01 ^ old) & 0x10) ? FLAG_H : 0);
+          m = 1;
+          break;
+        }
+        case 0x35:
+        {
+          uint8_t res = bus_read(gb, REG_HL) - 1;
+          f = (f & FLAG_C) | FLAG_N | (res ? 0 : FLAG_Z) | (((res & 0xF) == 0xF) ? FLAG_H : 0);
+          CORE_WRITE(gb, REG_HL, res);
+          m = 1;
+          break;
+        }
+        case 0x36: CORE_WRITE(gb, REG_HL, FETCH()); m = 2; break;
+        case 0x37: f = (f & FLAG_Z) | FLAG_C; m = 1; break;
+        case 0x38: JR(f & FLAG_C); break;
+        case 0x39: ADD16(sp); m = 1; break;
+        case 0x3A: a = bus_read(gb, REG_HL); SET_HL(REG_HL - 1); m = 1; break;
+        case 0x3B: sp--; m = 1; break;
+        case 0x3C: INC8(a); m = 1; break;
+        case 0x3D: DEC8(a); m = 1; break;
+        case 0x3E: a = FETCH(); m = 2; break;
+        case 0x3F: f = (f & FLAG_Z) | ((f & FLAG_C) ? 0 : FLAG_C); m = 1; break;
+
+        LD_BLOCK(0x40, b)
+        LD_BLOCK(0x48, c)
+        LD_BLOCK(0x50, d)
+        LD_BLOCK(0x58, e)
+        LD_BLOCK(0x60, h)
+        LD_BLOCK(0x68, l)
+
+        case 0x70: CORE_WRITE(gb, REG_HL, b); m = 1; break;
+        case 0x71: CORE_WRITE(gb, REG_HL, c); m = 1; break;
+        case 0x72: CORE_WRITE(gb, REG_HL, d); m = 1; break;
+        case 0x73: CORE_WRITE(gb, REG_HL, e); m = 1; break;
+        case 0x74: CORE_WRITE(gb, REG_HL, h); m = 1; break;
+        case 0x75: CORE_WRITE(gb, REG_HL, l); m = 1; break;
+        case 0x76:
+          // Not entered with an enabled interupt already pending, see
+          // opcode_0x76
+          if (!(gb->mmu.memory[0xFF0F] & gb->mmu.memory[0xFFFF] & 0x1F))
+            gb->mmu.HALT = 1;
+          m = 1;
+          break;
+        case 0x77: CORE_WRITE(gb, REG_HL, a); m = 1; break;
+
+        LD_BLOCK(0x78, a)
+
+        ALU_BLOCK(0x80, ADD8)
+        ALU_BLOCK(0x88, ADC8)
+        ALU_BLOCK(0x90, SUB8)
+        ALU_BLOCK(0x98, SBC8)
+        ALU_BLOCK(0xA0, AND8)
+        ALU_BLOCK(0xA8, XOR8)
+        ALU_BLOCK(0xB0, OR8)
+        ALU_BLOCK(0xB8, CP8)
+
+        case 0xC0: RET(!(f & FLAG_Z)); break;
+        case 0xC1: { uint16_t v; POP(v); SET_BC(v); m = 1; break; }
+        case 0xC2: JP(!(f & FLAG_Z)); break;
+        case 0xC3: pc = FETCH16(); m = 3; break;
+        case 0xC4: CALL(!(f & FLAG_Z)); break;
+        case 0xC5: PUSH(REG_BC); m = 1; break;
+        case 0xC6: ADD8(FETCH()); m = 1; break;
+        case 0xC7: RST(0x00); break;
+        case 0xC8: RET(f & FLAG_Z); break;
+        case 0xC9: POP(pc); m = 1; break;
+        case 0xCA: JP(f & FLAG_Z); break;
+        case 0xCB:
+        {
+          uint8_t cb = FETCH();
+          uint8_t z = cb & 7;
+          if ((cb >> 6) == 1)
+            prefix_op(cb, GET_R8(z, bus_read(gb, REG_HL)), &f);
+          else
+          {
+            uint8_t v = prefix_op(cb, GET_R8(z, gb->mmu.memory[REG_HL]), &f);
+            SET_R8(z, v);
+            if (z == 6 && (REG_HL == 0xFF0F || REG_HL == 0xFFFF))
+              CHECK_INTERUPT();
+          }
+          m = 2;
+          break;
+        }
+        case 0xCC: CALL(f & FLAG_Z); break;
+        case 0xCD: CALL(1); break;
+        case 0xCE: ADC8(FETCH()); m = 2; break;
+        case 0xCF: RST(0x08); break;
+
+        case 0xD0: RET(!(f & FLAG_C)); break;
+        case 0xD1: { uint16_t v; POP(v); SET_DE(v); m = 1; break; }
+        case 0xD2: JP(!(f & FLAG_C)); break;
+        case 0xD4: CALL(!(f & FLAG_C)); break;
+        case 0xD5: PUSH(REG_DE); m = 1; break;
+        case 0xD6: SUB8(FETCH()); m = 1; break;
+        case 0xD7: RST(0x10); break;
+        case 0xD8: RET(f & FLAG_C); break;
+        case 0xD9: POP(pc); ime = 1; CHECK_INTERUPT(); m = 1; break;
+        case 0xDA: JP(f & FLAG_C); break;
+        case 0xDC: CALL(f & FLAG_C); break;
+        case 0xDE: SBC8(FETCH()); m = 1; break;
+        case 0xDF: RST(0x18); break;
+
+        case 0xE0: CORE_WRITE(gb, 0xFF00 + FETCH(), a); m = 2; break;
+        case 0xE1: { uint16_t v; POP(v); SET_HL(v); m = 1; break; }
+        case 0xE2: CORE_WRITE(gb, 0xFF00 + c, a); m = 2; break;
+        case 0xE5: PUSH(REG_HL); m = 1; break;
+        case 0xE6: AND8(FETCH()); m = 2; break;
+        case 0xE7: RST(0x20); break;
+        case 0xE8:
+        {
+          int8_t tmp = FETCH();
+          uint16_t res = sp + tmp;
+          f = (((sp ^ tmp ^ res) & 0x100) ? FLAG_C : 0) | (((sp ^ tmp ^ res) & 0x10) ? FLAG_H : 0);
+          sp = res;
+          m = 2;
+          break;
+        }
+        case 0xE9: pc = REG_HL; m = 1; break;
+        case 0xEA: CORE_WRITE(gb, FETCH16(), a); m = 3; break;
+        case 0xEE: XOR8(FETCH()); m = 1; break;
+        case 0xEF: RST(0x28); break;
+
+        case 0xF0: a = bus_read(gb, 0xFF00 + FETCH()); m = 2; break;
+        case 0xF1: { uint16_t v; POP(v); a = v >> 8; f = v & 0xF0; m = 1; break; }
+        case 0xF2: a = bus_read(gb, 0xFF00 + c); m = 2; break;
+        case 0xF3: ime = 0; m = 1; break;
+        case 0xF5: PUSH((a << 8) | f); m = 1; break;
+        case 0xF6: OR8(FETCH()); m = 2; break;
+        case 0xF7: RST(0x30); break;
+        case 0xF8:
+        {
+          uint8_t tmp = FETCH();
+          uint8_t low = sp & 0xFF;
+          // Flags set only on low bytes of SP
+          f = ((((uint16_t)tmp + low) > 255) ? FLAG_C : 0)
+            | ((((tmp & 0xF) + (low & 0xF)) & 0x10) ? FLAG_H : 0);
+          SET_HL(sp + (int8_t)tmp);
+          m = 2;
+          break;
+        }
+        case 0xF9: sp = REG_HL; m = 1; break;
+        case 0xFA: a = bus_read(gb, FETCH16()); m = 3; break;
+        case 0xFB: ime = 1; CHECK_INTERUPT(); m = 1; break;
+        case 0xFE: CP8(FETCH()); m = 2; break;
+        case 0xFF: RST(0x38); break;
+
+        default:
+          fprintf(stderr, "Unknown Op %x at address %x", op, pc - 1);
+          exit(1);
+      }
+    }
+    else if (gb->scheduler.next > gb->clock.cycles)
+    {
+      // Nothing can wake the CPU before the next event, skip straight to it
+      m = gb->scheduler.next - gb->clock.cycles;
+    }
+
+    gb->clock.cycles += m;
+    if (gb->clock.cycles < gb->scheduler.next)
+      continue;
+
+    events = run_events(gb, pixels, display);
+    uint8_t pending = gb->mmu.memory[0xFF0F] & gb->mmu.memory[0xFFFF] & 0x1F;
+    if ((events & (1 << EVENT_INTERUPT)) && pending)
+    {
+      // An enabled interupt ends HALT even when IME is off
+      if (gb->mmu.HALT)
+      {
+        gb->mmu.HALT = 0;
+        host_idle(gb);
+      }
+
+      if (ime)
+      {
+        uint8_t i = 0;
+        while (!(pending & (1 << i)))
+          i++;
+
+        ime = 0;
+        gb->mmu.memory[0xFF0F] &= ~(1 << i);
+        PUSH(pc);
+        if (i != 3)
+          pc = interupt_vectors[i];
+      }
+    }
+
+    if (*display || (events & ((1 << EVENT_STOP) | (1 << EVENT_MAPPER))))
+      break;
+  }
+
+  gb->r.AF.bytes.high = a;
+  gb->r.AF.bytes.low = f;
+  gb->r.BC.bytes.high = b;
+  gb->r.BC.bytes.low = c;
+  gb->r.DE.bytes.high = d;
+  gb->r.DE.bytes.low = e;
+  gb->r.HL.bytes.high = h;
+  gb->r.HL.bytes.low = l;
+  gb->r.SP.val = sp;
+  gb->r.PC.val = pc;
+  gb->r.ime = ime;
+
+  return events;
+}
+
+#undef CORE_RUN
+#undef CORE_WRITE
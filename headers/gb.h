@@ -0,0 +1,56 @@
+#ifndef GB_H
+# define GB_H
+
+#include "context.h"
+#include "vram.h"
+#include "pixel.h"
+#include "state.h"
+#include "rewind.h"
+#include "runahead.h"
+#include "movie.h"
+
+// Embedding API. A machine made by gb_create is not paced to the wall
+// clock: it runs as fast as the host allows, only when it is stepped.
+
+// Bytes per row of the frame buffer, one ARGB8888 pixel (see pixel.h) in
+// 4 bytes
+# define GB_FRAMEBUFFER_PITCH (SCREEN_WIDTH * 4)
+
+// Power on a machine running the ROM at `rom_path`, which must outlive it.
+// NULL if the ROM or the boot ROM can't be loaded.
+GbContext *gb_create(char *rom_path);
+// The same with the boot ROM at `bios_path` instead of BIOS_PATH
+GbContext *gb_create_with_bios(char *rom_path, char *bios_path);
+void gb_destroy(GbContext *gb);
+
+// Run until the next VBLANK, returns the m-cycles executed
+uint32_t gb_run_frame(GbContext *gb);
+
+// Run for at least `cycles` m-cycles, returns the number of frames
+// completed meanwhile
+int gb_run_cycles(GbContext *gb, uint32_t cycles);
+
+// Last completed frame, 160x144 pixels
+const uint8_t *gb_framebuffer(const GbContext *gb);
+
+// The same frame as one shade per byte, 0 (lightest) to 3, whatever the
+// host colour scheme
+const uint8_t *gb_screen_shades(const GbContext *gb);
+
+// Called once every instance of a lockstep round has reached `frame`
+typedef void (*Gb_round_hook)(void *arg, uint32_t frame);
+
+// Run many machines on the calling thread, one frame each in turn, so they
+// all stay on the same frame. Each one runs until its VBLANK and then
+// yields to the next. NULL entries are skipped, the hook may clear an
+// entry to drop that machine from the following rounds.
+void gb_run_lockstep(GbContext *gbs[], int count, uint32_t frames, Gb_round_hook hook, void *arg);
+
+// FNV-1a hash of the 160x144 game screen of the last frame
+uint64_t gb_screen_hash(const GbContext *gb);
+
+// Buttons currently held, one bit per button cleared when pressed:
+// Right, Left, Up, Down, A, B, Select, Start
+void gb_set_joypad(GbContext *gb, uint8_t state);
+
+#endif /* GB_H */
@@ -0,0 +1,11 @@
+#ifndef INPUT_H
+# define INPUT_H
+
+#include "registers.h"
+
+void input_set_rate(int polls_per_frame);
+uint32_t input_poll_cycles(void);
+int input_poll(GbContext *gb);
+int input_rewind(void);
+
+#endif /* INPUT_H */
@@ -4,13 +4,27 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "registers.h"
-#include "utils.h"
+
+typedef enum Mapper
+{
+  MAPPER_ROM_ONLY = 0,
+  MAPPER_MBC1,
+  MAPPER_MBC2
+} Mapper;
+
+// Pages tracked for incremental snapshots: the 256 pages of the memory map,
+// then the pages of the largest cartridge RAM
+# define DIRTY_PAGES (0x100 + 0x20000 / 0x100)
 
 typedef struct Mmu
 {
   uint8_t memory[0x10000];
-  uint8_t ram[0x2000000];
-  uint8_t game[0x2000000];
+  uint8_t *ram;
+  const uint8_t *game;
+  uint32_t ram_size;
+  uint32_t rom_size;
+  uint32_t rom_banks;
+  uint8_t rom_mapped;
   uint8_t MBC1;
   uint8_t MBC2;
   uint8_t CUR_ROM;
@@ -20,19 +34,46 @@ typedef struct Mmu
   uint8_t HALT;
   uint8_t MEMORY_MODEL;
   uint8_t BIOS_MODE;
+  Mapper mapper;
   char *path_rom;
+  char *path_bios;          // NULL for BIOS_PATH
+  const uint8_t *read_page[0x100];
+  uint8_t *write_page[0x100];
+
+  // Set for a page written since the last state_clear_dirty. dirty_page[p]
+  // is the entry of the page write_page[p] points at, the RAM bank or p.
+  uint8_t dirty[DIRTY_PAGES];
+  uint16_t dirty_page[0x100];
 } Mmu;
 
-Mmu MMU;
-
-void init_mmu(char *path);
-void load_rom(char *path);
-void load_bios(char *path);
-void print_memory(uint16_t from, uint16_t to);
-uint8_t read_memory(uint16_t addr);
-void write_memory(uint16_t addr, uint8_t val);
-void request_interupt(uint8_t val);
-void do_interupt(void);
-void execute_interupt(uint8_t i);
+// Flag the page behind a write through write_page
+# define MARK_WRITE(gb, addr) ((gb)->mmu.dirty[(gb)->mmu.dirty_page[(addr) >> 8]] = 1)
+// Flag a page of the memory map written directly
+# define MARK_DIRTY(gb, addr) ((gb)->mmu.dirty[(addr) >> 8] = 1)
+
+
+// Boot ROM used unless mmu.path_bios is set
+# define BIOS_PATH "misc/bios.bin"
+
+// These return -1 when a file can't be loaded, after saying why
+int init_mmu(GbContext *gb, char *path);
+int load_rom(GbContext *gb, char *path);
+int load_bios(GbContext *gb, char *path);
+void free_mmu(GbContext *gb);
+void map_pages(GbContext *gb);
+void map_banks(GbContext *gb);
+void print_memory(GbContext *gb, uint16_t from, uint16_t to);
+void joypad_set(GbContext *gb, uint8_t state);
+uint8_t read_slow(GbContext *gb, uint16_t addr);
+void write_mbc1(GbContext *gb, uint16_t addr, uint8_t val);
+void write_mbc2(GbContext *gb, uint16_t addr, uint8_t val);
+void write_bios(GbContext *gb, uint16_t addr, uint8_t val);
+void write_io(GbContext *gb, uint16_t addr, uint8_t val);
+void write_slow(GbContext *gb, uint16_t addr, uint8_t val);
+uint8_t read_memory(GbContext *gb, uint16_t addr);
+void write_memory(GbContext *gb, uint16_t addr, uint8_t val);
+void request_interupt(GbContext *gb, uint8_t val);
+void do_interupt(GbContext *gb);
+void execute_interupt(GbContext *gb, uint8_t i);
 
 #endif /* MMU_H */
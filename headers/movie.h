@@ -0,0 +1,41 @@
+#ifndef MOVIE_H
+# define MOVIE_H
+
+#include <stdint.h>
+
+// Joypad input keyed by frame. The file is "GBMV", a version byte, then a
+// 5 bytes record per change of input: the frame it applies from (32 bits
+// little endian) and the joypad state, one bit cleared per held button.
+# define MOVIE_VERSION 1
+
+typedef struct MovieEvent
+{
+  uint32_t frame;
+  uint8_t joypad;
+} MovieEvent;
+
+typedef struct Movie
+{
+  MovieEvent *events;
+  uint32_t count;
+  uint32_t capacity;
+  uint32_t cursor;          // next event to apply
+  uint8_t joypad;           // state at the last frame asked for
+} Movie;
+
+int movie_load(Movie *m, const char *path);
+void movie_free(Movie *m);
+uint8_t movie_input(Movie *m, uint32_t frame);
+
+// Recording: an empty movie, then the joypad state before every frame. Only
+// the changes are kept. movie_end marks the frame the recording stopped at.
+// Both return -1 when there is no memory left for the event.
+void movie_init(Movie *m);
+int movie_record(Movie *m, uint32_t frame, uint8_t joypad);
+int movie_end(Movie *m, uint32_t frame);
+int movie_save(const Movie *m, const char *path);
+
+// Frames covered by the movie, up to its last event
+uint32_t movie_length(const Movie *m);
+
+#endif /* MOVIE_H */
@@ -0,0 +1,43 @@
+#ifndef PACER_H
+# define PACER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "timing.h"
+
+// Wall time of one frame at 1x, 16742706 ns or about 59.73 frames per
+// second
+# define PACER_FRAME_NS ((int64_t)FRAME_CYCLES * 1000000000 / SECOND_CYCLES)
+
+# define PACER_UNLIMITED 0.0
+# define PACER_MIN_SPEED 0.5
+# define PACER_MAX_SPEED 16.0
+
+// Keeps the emulated frames in step with the wall clock. Every VBLANK
+// sleeps until an absolute deadline, one frame after the previous one, so
+// oversleeping on one frame is caught up on the next instead of drifting.
+typedef struct Pacer
+{
+  int64_t frame_ns;           // wall time per frame, 0 when unlimited
+  int started;
+  struct timespec frame_start; // deadline the current frame was shown at
+  uint64_t frame_cycles;      // cycle the current frame started at
+
+  // How late each frame was shown, in ns
+  uint64_t frames;
+  uint64_t dropped;           // frames so late the deadline was reset
+  int64_t jitter_max;
+  int64_t jitter_total;
+
+  // Host time spent blocked, waiting for a deadline or idle in HALT
+  int64_t slept_ns;
+} Pacer;
+
+void pacer_init(Pacer *p);
+void pacer_set_speed(Pacer *p, double speed);
+void pacer_frame(Pacer *p, uint64_t cycles);
+int64_t pacer_ahead_ns(const Pacer *p, uint64_t cycles);
+void pacer_report(const Pacer *p, FILE *out);
+
+#endif /* PACER_H */
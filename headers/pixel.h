@@ -0,0 +1,31 @@
+#ifndef PIXEL_H
+# define PIXEL_H
+
+#include <stdint.h>
+
+// Pixel kernels: expand one tile row, the two bitplane bytes `lo` and `hi`,
+// into 8 colour indices and store their `lut` entries as 8 pixels of 4
+// bytes each at `out`, leftmost pixel from bit 7. The masked form leaves
+// the pixels whose entry is 0 untouched, for sprites.
+typedef void (*Pixel_expand)(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out);
+
+typedef struct Pixel_kernel
+{
+  const char *name;
+  Pixel_expand expand;
+  Pixel_expand expand_masked;
+} Pixel_kernel;
+
+// Every kernel built in, scalar first, ending with an empty entry
+extern const Pixel_kernel pixel_kernels[];
+
+int pixel_kernel_supported(const Pixel_kernel *kernel);
+
+// The fastest kernel this CPU runs, chosen on first use
+const Pixel_kernel *pixel_kernel(void);
+
+// A pixel as the framebuffer holds it: ARGB8888 in native byte order, the
+// layout of SDL_PIXELFORMAT_ARGB8888
+uint32_t pixel_argb(uint8_t alpha, uint8_t red, uint8_t green, uint8_t blue);
+
+#endif /* PIXEL_H */
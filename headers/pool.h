@@ -0,0 +1,11 @@
+#ifndef POOL_H
+# define POOL_H
+
+// Runs task(arg, i) for every i in [0, count) on `threads` threads and
+// returns once they are all done. A task returns non-zero when it failed,
+// the others still run, pool_run returns how many failed.
+typedef int (*Pool_task)(void *arg, int index);
+
+int pool_run(int threads, int count, Pool_task task, void *arg);
+
+#endif /* POOL_H */
@@ -3,7 +3,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
-#include "helpers_op.h"
+#include <stdint.h>
+
+// One emulated Game Boy, see context.h
+typedef struct GbContext GbContext;
 
 struct RegisterByte
 {
@@ -34,99 +37,95 @@ typedef struct my_clock
 {
   uint16_t m;
   uint16_t t;
-  uint32_t total_m;
-  uint32_t total_t;
+  uint64_t cycles;        // m-cycles since power on, never reset
   uint8_t mode;
-  uint16_t lineticks;
-  uint16_t divider;
-  int timer_counter;
+  uint64_t mode_start;    // cycle the current PPU mode (or VBLANK line) began
+  uint64_t div_start;     // cycle of the last DIV increment or reset
+  uint64_t timer_start;   // cycle TIMA last counted from, while TAC is enabled
+  int timer_counter;      // counter kept while TAC is disabled
   int clock_speed;
 } My_clock;
 
-My_clock my_clock;
-void (*Opcodes[0x100]) (void);
-void (*PrefixCB[0x100]) (void);
-Registers r;
 
-void init_registers(void);
-void print_r(void);
+void init_registers(GbContext *gb);
+void print_r(GbContext *gb);
 int test_bit(const uint8_t byte, const uint8_t index);
 
-void setZ(void);
-void resetZ(void);
-void setN(void);
-void resetN(void);
-void setH(void);
-void resetH(void);
-void setC(void);
-void resetC(void);
+void setZ(GbContext *gb);
+void resetZ(GbContext *gb);
+void setN(GbContext *gb);
+void resetN(GbContext *gb);
+void setH(GbContext *gb);
+void resetH(GbContext *gb);
+void setC(GbContext *gb);
+void resetC(GbContext *gb);
 
-uint8_t getZ(void);
-uint8_t getN(void);
-uint8_t getH(void);
-uint8_t getC(void);
+uint8_t getZ(GbContext *gb);
+uint8_t getN(GbContext *gb);
+uint8_t getH(GbContext *gb);
+uint8_t getC(GbContext *gb);
 
 // B register load instructions
-void loadba(void);
-void loadbb(void);
-void loadbc(void);
-void loadbd(void);
-void loadbe(void);
-void loadbh(void);
-void loadbl(void);
+void loadba(GbContext *gb);
+void loadbb(GbContext *gb);
+void loadbc(GbContext *gb);
+void loadbd(GbContext *gb);
+void loadbe(GbContext *gb);
+void loadbh(GbContext *gb);
+void loadbl(GbContext *gb);
 
 // C register load instructions
-void loadca(void);
-void loadcb(void);
-void loadcc(void);
-void loadcd(void);
-void loadce(void);
-void loadch(void);
-void loadcl(void);
+void loadca(GbContext *gb);
+void loadcb(GbContext *gb);
+void loadcc(GbContext *gb);
+void loadcd(GbContext *gb);
+void loadce(GbContext *gb);
+void loadch(GbContext *gb);
+void loadcl(GbContext *gb);
 
 // D register load instructions
-void loadda(void);
-void loaddb(void);
-void loaddc(void);
-void loaddd(void);
-void loadde(void);
-void loaddh(void);
-void loaddl(void);
+void loadda(GbContext *gb);
+void loaddb(GbContext *gb);
+void loaddc(GbContext *gb);
+void loaddd(GbContext *gb);
+void loadde(GbContext *gb);
+void loaddh(GbContext *gb);
+void loaddl(GbContext *gb);
 
 // E register load instructions
-void loadea(void);
-void loadeb(void);
-void loadec(void);
-void loaded(void);
-void loadee(void);
-void loadeh(void);
-void loadel(void);
+void loadea(GbContext *gb);
+void loadeb(GbContext *gb);
+void loadec(GbContext *gb);
+void loaded(GbContext *gb);
+void loadee(GbContext *gb);
+void loadeh(GbContext *gb);
+void loadel(GbContext *gb);
 
 // H register load instructions
-void loadha(void);
-void loadhb(void);
-void loadhc(void);
-void loadhd(void);
-void loadhe(void);
-void loadhh(void);
-void loadhl(void);
+void loadha(GbContext *gb);
+void loadhb(GbContext *gb);
+void loadhc(GbContext *gb);
+void loadhd(GbContext *gb);
+void loadhe(GbContext *gb);
+void loadhh(GbContext *gb);
+void loadhl(GbContext *gb);
 
 // L register load instructions
-void loadla(void);
-void loadlb(void);
-void loadlc(void);
-void loadld(void);
-void loadle(void);
-void loadlh(void);
-void loadll(void);
+void loadla(GbContext *gb);
+void loadlb(GbContext *gb);
+void loadlc(GbContext *gb);
+void loadld(GbContext *gb);
+void loadle(GbContext *gb);
+void loadlh(GbContext *gb);
+void loadll(GbContext *gb);
 
 // A register load instructions
-void loadaa(void);
-void loadab(void);
-void loadac(void);
-void loadad(void);
-void loadae(void);
-void loadah(void);
-void loadal(void);
+void loadaa(GbContext *gb);
+void loadab(GbContext *gb);
+void loadac(GbContext *gb);
+void loadad(GbContext *gb);
+void loadae(GbContext *gb);
+void loadah(GbContext *gb);
+void loadal(GbContext *gb);
 
 #endif /* REGISTERS_H */
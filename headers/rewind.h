@@ -0,0 +1,52 @@
+#ifndef REWIND_H
+# define REWIND_H
+
+#include "context.h"
+
+// Rewind history, one state per frame in a ring of fixed size. Every
+// REWIND_KEYFRAME_INTERVAL frames a keyframe is kept whole, the states in
+// between are XORed with their keyframe. Both are run length encoded, so
+// the long runs of unchanged bytes cost next to nothing. The oldest
+// frames are dropped when the ring is full.
+# define REWIND_KEYFRAME_INTERVAL 60
+
+typedef struct RewindEntry
+{
+  size_t offset;            // in data
+  uint32_t len;
+  uint64_t key;             // frame number of its keyframe
+} RewindEntry;
+
+typedef struct Rewind
+{
+  uint8_t *data;
+  size_t capacity;
+  size_t head;              // where the next entry goes
+
+  RewindEntry *entries;     // ring of the frames kept, oldest first
+  uint32_t max_entries;
+  uint32_t first;
+  uint32_t count;
+  uint64_t first_frame;     // frame number of the oldest entry
+
+  size_t state_len;
+  uint8_t *state;           // scratch, the state being saved or restored
+  uint8_t *base;            // the decoded keyframe the newest entries use
+  uint64_t base_key;        // frame number of the keyframe in base
+  uint8_t *encoded;         // scratch for encoding
+} Rewind;
+
+// Up to `frames` frames of `gb` in at most `bytes` of history
+Rewind *rewind_new(const GbContext *gb, uint32_t frames, size_t bytes);
+void rewind_free(Rewind *rw);
+
+// Record the current state, once per frame
+void rewind_push(Rewind *rw, const GbContext *gb);
+
+// Restore the newest recorded state and drop it, -1 if there is none left
+int rewind_pop(Rewind *rw, GbContext *gb);
+
+// Bytes of history in use
+size_t rewind_used(const Rewind *rw);
+
+#endif /* REWIND_H */
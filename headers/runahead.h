@@ -0,0 +1,38 @@
+#ifndef RUNAHEAD_H
+# define RUNAHEAD_H
+
+#include "context.h"
+
+// Run-ahead hides the game's own input lag: every frame the machine is
+// saved, run `frames` frames further with the current input, the last one
+// is left on screen, and the machine is put back. The frames ahead are not
+// paced, they must all fit in the frame period.
+# define RUNAHEAD_MAX_FRAMES 8
+# define RUNAHEAD_AUTO -1
+
+typedef struct Runahead
+{
+  int frames;               // frames run ahead, RUNAHEAD_AUTO to pick it
+  int current;              // frames ahead of the last frame
+  size_t state_len;
+  uint8_t *state;
+
+  // Host time of one emulated frame and of a save plus load, averaged
+  int64_t frame_cost_ns;
+  int64_t copy_cost_ns;
+  int64_t headroom_ns;      // left in the last frame period
+} Runahead;
+
+Runahead *runahead_new(const GbContext *gb, int frames);
+void runahead_free(Runahead *ra);
+
+// Run the next frame, then the frames ahead of it. Returns the m-cycles of
+// the real frame.
+uint32_t runahead_frame(Runahead *ra, GbContext *gb);
+
+// Frames ahead that fit in three quarters of a frame period
+int runahead_fit(const Runahead *ra, const Pacer *p);
+
+void runahead_report(const Runahead *ra, FILE *out);
+
+#endif /* RUNAHEAD_H */
@@ -0,0 +1,34 @@
+#ifndef SCHEDULER_H
+# define SCHEDULER_H
+
+#include <stdint.h>
+
+# define EVENT_NEVER UINT64_MAX
+
+typedef enum EventType
+{
+  EVENT_PPU = 0,      // next PPU mode change
+  EVENT_TIMER,        // next TIMA increment
+  EVENT_DIV,          // next DIV increment
+  EVENT_INTERUPT,     // IF, IE or IME changed, check for an interupt
+  EVENT_STOP,         // end of the cycles given to cpu_run
+  EVENT_MAPPER,       // BIOS unmapped, the core must change its loop
+  EVENT_COUNT
+} EventType;
+
+// Min-heap of the pending events, ordered by deadline in m-cycles.
+typedef struct Scheduler
+{
+  uint64_t next;
+  uint64_t deadline[EVENT_COUNT];
+  uint8_t heap[EVENT_COUNT];
+  uint8_t pos[EVENT_COUNT];
+  uint8_t size;
+} Scheduler;
+
+void scheduler_init(Scheduler *s);
+void scheduler_schedule(Scheduler *s, EventType ev, uint64_t when);
+void scheduler_cancel(Scheduler *s, EventType ev);
+int scheduler_pop(Scheduler *s, uint64_t now);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,47 @@
+#ifndef STATE_H
+# define STATE_H
+
+#include <stddef.h>
+#include "context.h"
+
+// Save states. Only what the machine can change is kept: CPU registers,
+// clock and PPU timing, banking registers, pending events, the 64 KiB
+// memory map and the cartridge RAM. The ROM is not, a state can only be
+// loaded in a machine running the same cartridge. Neither is the frame
+// buffer, the next frame completed after a load is exact.
+//
+// The state is "GBST", a version byte, a kind byte, then the fields in host
+// byte order.
+# define STATE_VERSION 1
+
+# define STATE_FULL 0
+# define STATE_DELTA 1
+
+// Bytes needed to save `gb`, fixed for a given cartridge
+size_t state_size(const GbContext *gb);
+
+// Write the state of `gb` to `buf` of at least state_size bytes, returns
+// the bytes written
+size_t state_save(const GbContext *gb, uint8_t *buf);
+
+// Returns 0, or -1 if `buf` is not a state of this version and cartridge
+int state_load(GbContext *gb, const uint8_t *buf, size_t len);
+
+// Incremental snapshots. Writes flag their 256 bytes page dirty, a delta
+// only holds the pages written since state_clear_dirty, on top of the CPU
+// and clock state. Loading a full state flags every page.
+void state_clear_dirty(GbContext *gb);
+
+// Bytes a delta of `gb` can take at most
+size_t state_delta_max(const GbContext *gb);
+
+size_t state_save_delta(const GbContext *gb, uint8_t *buf);
+
+// Load a delta in a machine restored to the state it was cleared at.
+// Returns 0, or -1 if `buf` is not a delta of this version and cartridge.
+int state_load_delta(GbContext *gb, const uint8_t *buf, size_t len);
+
+int state_write(const GbContext *gb, const char *path);
+int state_read(GbContext *gb, const char *path);
+
+#endif /* STATE_H */
@@ -0,0 +1,19 @@
+#ifndef TIMING_H
+# define TIMING_H
+
+// Cycles per second of the clock everything below is counted in
+# define SECOND_CYCLES 4194304
+
+// Cycles the PPU spends in each mode, VBLANK is counted per line. A
+// visible line is as long as a VBLANK one.
+# define HBLANK_CYCLES 204
+# define VBLANK_LINE_CYCLES 456
+# define OAM_CYCLES 80
+# define TRANSFER_CYCLES 172
+
+// Cycles between two VBLANK: 144 visible lines, then 10 lines of VBLANK,
+// 70224 in all
+# define FRAME_CYCLES (144 * (OAM_CYCLES + TRANSFER_CYCLES + HBLANK_CYCLES) \
+  + 10 * VBLANK_LINE_CYCLES)
+
+#endif /* TIMING_H */
@@ -5,29 +5,38 @@
 #include "registers.h"
 #include "helpers_op.h"
 #include "vram.h"
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
+#include "scheduler.h"
+#include "context.h"
+#include "timing.h"
 #include <sys/time.h>
 
-void init(void);
-void load_opcodes(void);
-void load_prefixcb(void);
-void execute(uint16_t op, uint8_t pixels[], int *display);
+int init(GbContext *gb);
+void execute(GbContext *gb, uint16_t op, uint8_t pixels[], int *display);
+void init_events(GbContext *gb);
+int get_timer_counter(GbContext *gb);
+void set_timer_counter(GbContext *gb, int counter);
+void reset_divider(GbContext *gb);
+void check_coincidence(GbContext *gb);
+int run_events(GbContext *gb, uint8_t pixels[], int *display);
+int my_clock_handling(GbContext *gb, uint16_t m, uint8_t pixels[], int *display);
+void set_idle_handler(GbContext *gb, Idle_handler handler);
+void set_cpu_report(GbContext *gb, int enable);
+void host_idle(GbContext *gb);
 
-void loadhlpa(void);
-void loadhlma(void);
-void opcode_0x01(void);
-void opcode_0x11(void);
-void opcode_0x21(void);
-void opcode_0x31(void);
+void loadhlpa(GbContext *gb);
+void loadhlma(GbContext *gb);
+void opcode_0x01(GbContext *gb);
+void opcode_0x11(GbContext *gb);
+void opcode_0x21(GbContext *gb);
+void opcode_0x31(GbContext *gb);
 void loadspd16(void);
-void prefixcb(void);
+void prefixcb(GbContext *gb);
 void jrnz(void);
-void loadcd8(void);
-void loaded8(void);
-void loadld8(void);
-void loadad8(void);
-void opcode_0x0c(void);
-void opcode_0xe2(void);
+void loadcd8(GbContext *gb);
+void loaded8(GbContext *gb);
+void loadld8(GbContext *gb);
+void loadad8(GbContext *gb);
+void opcode_0x0c(GbContext *gb);
+void opcode_0xe2(GbContext *gb);
 
 #endif
@@ -3,10 +3,74 @@
 
 #include "mmu.h"
 #include "registers.h"
-#include <SDL2/SDL.h>
 
-void print_tiles(uint8_t pixels[]);
-void print_sprites(uint8_t pixels[]);
-void print_vram(uint8_t pixels[]);
+// The game screen. The PPU draws each line into both screen buffers of
+// GbContext: `framebuffer` holds ARGB pixels (see pixel.h) and `shades`
+// the shade, 0 (lightest) to 3, of every pixel.
+# define SCREEN_WIDTH 160
+# define SCREEN_HEIGHT 144
+
+// Surface print_vram draws the 384 tiles of 0x8000-0x97FF into, 32 a row
+# define VRAM_VIEW_WIDTH 256
+# define VRAM_VIEW_HEIGHT 96
+
+// Tile data decoded to one colour index (0 to 3) per pixel, for the 384
+// tiles of 0x8000-0x97FF. Writing to a tile flags it stale, it is decoded
+// again the next time it is drawn.
+typedef struct TileCache
+{
+  uint8_t pixels[384][8][8];
+  uint8_t stale[384];
+  // Bumped on every decode, so the users of a tile can tell it changed
+  uint32_t version[384];
+} TileCache;
+
+// The two 256x256 background maps (0x9800 and 0x9C00) drawn through BGP,
+// in both formats of the screen buffers. A cell is drawn again when its
+// map entry now points at another tile or its tile was decoded again
+// since, and every cell is when BGP changes.
+typedef struct BgCache
+{
+  uint8_t plane[2][256][256 * 4];
+  uint8_t shade[2][256][256];
+  uint16_t cell_tile[2][1024];
+  uint32_t cell_version[2][1024];
+} BgCache;
+
+// BGP, OBP0 and OBP1 as the pixels each colour number comes out as in the
+// host colour scheme, and as the shade each comes out as. Rebuilt when one
+// of them is written, the OBP colours mapped to shade 0 are 0 as sprites
+// leave them transparent.
+typedef struct Palettes
+{
+  uint32_t bgp[4];
+  uint32_t obp[2][4];
+  uint8_t bgp_shade[4];
+  uint8_t obp_shade[2][4];
+  int scheme;
+  uint8_t stale;  // written in place, rebuild all before drawing
+} Palettes;
+
+# define TILE_DATA_END 0x9800
+# define TILE_WRITE(gb, addr) do { if ((uint16_t)((addr) - 0x8000) < TILE_DATA_END - 0x8000) \
+  (gb)->tiles.stale[((addr) - 0x8000) >> 4] = 1; } while (0)
+# define PALETTE_WRITE(gb, addr) do { if ((uint16_t)((addr) - 0xFF47) < 3) \
+  (gb)->palettes.stale = 1; } while (0)
+
+// Everything in VRAM and the palettes may have changed, decode every tile,
+// rebuild the palettes and draw every background cell again
+void video_cache_reset(GbContext *gb);
+
+// Rebuild the palette at `addr`, one of 0xFF47 to 0xFF49, from its register
+void palette_update(GbContext *gb, uint16_t addr);
+
+// Host colours for the 4 shades: "grey" (the default), "dmg" or "pocket".
+// Returns -1 for an unknown name.
+int palette_set_scheme(GbContext *gb, const char *name);
+
+void print_tiles(GbContext *gb, uint8_t pixels[]);
+void print_sprites(GbContext *gb, uint8_t pixels[]);
+// Debug view of the tiles into a VRAM_VIEW_WIDTH x VRAM_VIEW_HEIGHT surface
+void print_vram(GbContext *gb, uint8_t pixels[]);
 
 #endif
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "gb.h"
+#include "movie.h"
+#include "pool.h"
+
+// Runs a list of headless sessions on every core, one machine per job.
+//
+// Each line of the job list is
+//   <rom> <movie or -> <frames> [screen,memory,hashes]
+// Blank lines and lines starting with # are skipped. For job N the results
+// go to <out>/job-N.txt, plus job-N.ppm for the last screen, job-N.mem for
+// the 64 KiB memory map and job-N.hashes for one screen hash per frame.
+//
+// With -l the jobs are not spread over threads but interleaved on the
+// calling one: every machine runs one frame in turn, so they move forward
+// in lockstep, frame by frame. -b gives the boot ROM every machine starts
+// from. A job whose files can't be loaded fails on its own, the others
+// still run.
+
+#define OUTPUT_SCREEN 1
+#define OUTPUT_MEMORY 2
+#define OUTPUT_HASHES 4
+
+typedef struct Job
+{
+  char *rom;
+  char *movie;
+  uint32_t frames;
+  int outputs;
+
+  GbContext *gb;
+  Movie input;
+  FILE *hashes;
+  double start;
+
+  int failed;
+  uint64_t cycles;
+  uint64_t screen_hash;
+  double seconds;
+} Job;
+
+typedef struct Batch
+{
+  Job *jobs;
+  int count;
+  const char *out;
+  char *bios;         // NULL for BIOS_PATH
+  GbContext **gbs;    // lockstep mode, machines still running
+} Batch;
+
+static double now_seconds(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static FILE *open_output(const Batch *batch, int index, const char *ext)
+{
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/job-%d.%s", batch->out, index, ext);
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    fprintf(stderr, "Could not write %s\n", path);
+  return file;
+}
+
+static void write_screen(FILE *file, const uint8_t *fb)
+{
+  fprintf(file, "P6\n160 144\n255\n");
+  for (int y = 0; y < 144; y++)
+  {
+    const uint8_t *row = fb + y * GB_FRAMEBUFFER_PITCH;
+    for (int x = 0; x < 160; x++)
+    {
+      uint32_t pixel;
+      memcpy(&pixel, &row[x * 4], 4);
+      const uint8_t rgb[3] = { pixel >> 16, pixel >> 8, pixel };
+      fwrite(rgb, 3, 1, file);
+    }
+  }
+}
+
+// Power on the machine of a job, 0 if it is ready to run
+static int job_start(Batch *batch, int index)
+{
+  Job *job = &batch->jobs[index];
+
+  job->start = now_seconds();
+  if (job->movie && movie_load(&job->input, job->movie))
+  {
+    job->failed = 1;
+    return -1;
+  }
+  job->gb = gb_create_with_bios(job->rom, batch->bios);
+  if (!job->gb)
+  {
+    fprintf(stderr, "job %d: cannot start %s\n", index, job->rom);
+    if (job->movie)
+      movie_free(&job->input);
+    job->failed = 1;
+    return -1;
+  }
+
+  if (job->outputs & OUTPUT_HASHES)
+    job->hashes = open_output(batch, index, "hashes");
+  if (job->movie)
+    gb_set_joypad(job->gb, movie_input(&job->input, 0));
+  return 0;
+}
+
+// Record `frame` once it is on screen and get the input of the next one
+static void job_frame(Job *job, uint32_t frame)
+{
+  if (job->hashes)
+    fprintf(job->hashes, "%u %016llx\n", frame, (unsigned long long)gb_screen_hash(job->gb));
+  if (job->movie)
+    gb_set_joypad(job->gb, movie_input(&job->input, frame + 1));
+}
+
+static void job_finish(Batch *batch, int index)
+{
+  Job *job = &batch->jobs[index];
+  GbContext *gb = job->gb;
+
+  job->cycles = gb->clock.cycles;
+  job->screen_hash = gb_screen_hash(gb);
+
+  FILE *file;
+  if ((job->outputs & OUTPUT_SCREEN) && (file = open_output(batch, index, "ppm")))
+  {
+    write_screen(file, gb_framebuffer(gb));
+    fclose(file);
+  }
+  if ((job->outputs & OUTPUT_MEMORY) && (file = open_output(batch, index, "mem")))
+  {
+    fwrite(gb->mmu.memory, sizeof(gb->mmu.memory), 1, file);
+    fclose(file);
+  }
+  if (job->hashes)
+    fclose(job->hashes);
+
+  gb_destroy(gb);
+  job->gb = NULL;
+  if (job->movie)
+    movie_free(&job->input);
+  job->seconds = now_seconds() - job->start;
+
+  if ((file = open_output(batch, index, "txt")))
+  {
+    fprintf(file, "rom %s\nmovie %s\nframes %u\ncycles %llu\nscreen %016llx\nseconds %.3f\n",
+            job->rom, job->movie ? job->movie : "-", job->frames,
+            (unsigned long long)job->cycles, (unsigned long long)job->screen_hash, job->seconds);
+    fclose(file);
+  }
+}
+
+// Pool task, a whole job on one worker
+static int run_job(void *arg, int index)
+{
+  Batch *batch = arg;
+  Job *job = &batch->jobs[index];
+
+  if (job_start(batch, index))
+    return -1;
+  for (uint32_t frame = 0; frame < job->frames; frame++)
+  {
+    gb_run_frame(job->gb);
+    job_frame(job, frame);
+  }
+  job_finish(batch, index);
+  return 0;
+}
+
+static void lockstep_round(void *arg, uint32_t frame)
+{
+  Batch *batch = arg;
+
+  for (int i = 0; i < batch->count; i++)
+  {
+    Job *job = &batch->jobs[i];
+    if (!batch->gbs[i])
+      continue;
+    job_frame(job, frame);
+    if (frame + 1 == job->frames)
+    {
+      batch->gbs[i] = NULL;
+      job_finish(batch, i);
+    }
+  }
+}
+
+// Every job on the calling thread, all of them on the same frame. Returns
+// the number of jobs that failed.
+static int run_lockstep(Batch *batch)
+{
+  uint32_t frames = 0;
+  int failed = 0;
+
+  batch->gbs = calloc(batch->count, sizeof(GbContext *));
+  for (int i = 0; i < batch->count; i++)
+  {
+    Job *job = &batch->jobs[i];
+    if (job_start(batch, i))
+    {
+      failed++;
+      continue;
+    }
+    if (!job->frames)
+    {
+      job_finish(batch, i);
+      continue;
+    }
+    batch->gbs[i] = job->gb;
+    if (job->frames > frames)
+      frames = job->frames;
+  }
+
+  gb_run_lockstep(batch->gbs, batch->count, frames, lockstep_round, batch);
+  free(batch->gbs);
+  return failed;
+}
+
+static int parse_outputs(const char *list)
+{
+  int outputs = 0;
+  if (strstr(list, "screen"))
+    outputs |= OUTPUT_SCREEN;
+  if (strstr(list, "memory"))
+    outputs |= OUTPUT_MEMORY;
+  if (strstr(list, "hashes"))
+    outputs |= OUTPUT_HASHES;
+  return outputs;
+}
+
+static void load_jobs(Batch *batch, const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if (!file)
+  {
+    fprintf(stderr, "Error loading job list %s\n", path);
+    exit(1);
+  }
+
+  char line[4096];
+  int capacity = 0;
+  int number = 0;
+  while (fgets(line, sizeof(line), file))
+  {
+    number++;
+    char *save;
+    char *rom = strtok_r(line, " \t\r\n", &save);
+    if (!rom || rom[0] == '#')
+      continue;
+    char *movie = strtok_r(NULL, " \t\r\n", &save);
+    char *frames = strtok_r(NULL, " \t\r\n", &save);
+    char *outputs = strtok_r(NULL, " \t\r\n", &save);
+    if (!movie || !frames)
+    {
+      fprintf(stderr, "%s:%d: expected <rom> <movie> <frames> [outputs]\n", path, number);
+      exit(1);
+    }
+
+    if (batch->count == capacity)
+    {
+      capacity = capacity ? capacity * 2 : 64;
+      batch->jobs = realloc(batch->jobs, capacity * sizeof(Job));
+    }
+    Job *job = &batch->jobs[batch->count++];
+    memset(job, 0, sizeof(*job));
+    job->rom = strdup(rom);
+    job->movie = strcmp(movie, "-") ? strdup(movie) : NULL;
+    job->frames = strtoul(frames, NULL, 10);
+    job->outputs = outputs ? parse_outputs(outputs) : 0;
+  }
+  fclose(file);
+}
+
+int main(int argc, char *args[])
+{
+  Batch batch = { NULL, 0, ".", NULL, NULL };
+  int threads = sysconf(_SC_NPROCESSORS_ONLN);
+  int lockstep = 0;
+  const char *list = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(args[i], "-j") == 0 && i + 1 < argc)
+      threads = atoi(args[++i]);
+    else if (strcmp(args[i], "-o") == 0 && i + 1 < argc)
+      batch.out = args[++i];
+    else if (strcmp(args[i], "-b") == 0 && i + 1 < argc)
+      batch.bios = args[++i];
+    else if (strcmp(args[i], "-l") == 0)
+      lockstep = 1;
+    else if (!list)
+      list = args[i];
+    else
+    {
+      printf("Unknown arg: %s\n", args[i]);
+      exit(1);
+    }
+  }
+  if (!list)
+  {
+    printf("usage: gb-batch [-j threads | -l] [-o outdir] [-b bios] <job list>\n");
+    exit(1);
+  }
+
+  load_jobs(&batch, list);
+
+  double start = now_seconds();
+  int failed;
+  if (lockstep)
+  {
+    threads = 1;
+    failed = run_lockstep(&batch);
+  }
+  else
+    failed = pool_run(threads, batch.count, run_job, &batch);
+  double seconds = now_seconds() - start;
+
+  uint64_t frames = 0;
+  for (int i = 0; i < batch.count; i++)
+  {
+    Job *job = &batch.jobs[i];
+    if (job->failed)
+    {
+      printf("job %d: %s failed\n", i, job->rom);
+      continue;
+    }
+    printf("job %d: %s %u frames screen %016llx %.3fs\n", i, job->rom, job->frames,
+           (unsigned long long)job->screen_hash, job->seconds);
+    frames += job->frames;
+  }
+  printf("%d jobs on %d threads in %.3fs, %.0f frames per second, %d failed\n",
+         batch.count, threads, seconds, seconds > 0 ? frames / seconds : 0.0, failed);
+
+  for (int i = 0; i < batch.count; i++)
+  {
+    free(batch.jobs[i].rom);
+    free(batch.jobs[i].movie);
+  }
+  free(batch.jobs);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,239 @@
+#include "cpu.h"
+
+// Switch based interpreter core. It does the same work as the Opcodes and
+// PrefixCB tables but keeps the registers in locals for the whole run, so
+// there is no indirect call and no load/store of `gb->r` per instruction.
+// The tables in utils.c are still used by the debugger.
+
+#define FLAG_Z 0x80
+#define FLAG_N 0x40
+#define FLAG_H 0x20
+#define FLAG_C 0x10
+
+#define REG_HL ((uint16_t)((h << 8) | l))
+#define SET_HL(v) do { uint16_t v_ = (v); h = v_ >> 8; l = v_ & 0xFF; } while (0)
+#define REG_BC ((uint16_t)((b << 8) | c))
+#define SET_BC(v) do { uint16_t v_ = (v); b = v_ >> 8; c = v_ & 0xFF; } while (0)
+#define REG_DE ((uint16_t)((d << 8) | e))
+#define SET_DE(v) do { uint16_t v_ = (v); d = v_ >> 8; e = v_ & 0xFF; } while (0)
+
+// Same as read_memory, inlined in the core. Writes are specialised per
+// mapper below.
+static inline uint8_t bus_read(GbContext *gb, uint16_t addr)
+{
+  const uint8_t *page = gb->mmu.read_page[addr >> 8];
+  if (page)
+    return page[addr & 0xFF];
+  return read_slow(gb, addr);
+}
+
+// While the BIOS is mapped every page but the I/O one is direct
+static inline void bios_write(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  uint8_t *page = gb->mmu.write_page[addr >> 8];
+  if (page)
+  {
+    page[addr & 0xFF] = val;
+    MARK_WRITE(gb, addr);
+  }
+  else
+    write_bios(gb, addr, val);
+}
+
+static inline void rom_only_write(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  uint8_t *page = gb->mmu.write_page[addr >> 8];
+  if (page)
+  {
+    page[addr & 0xFF] = val;
+    MARK_WRITE(gb, addr);
+  }
+  else if (addr >= 0x8000)
+    write_io(gb, addr, val);
+}
+
+static inline void mbc1_write(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  uint8_t *page = gb->mmu.write_page[addr >> 8];
+  if (page)
+  {
+    page[addr & 0xFF] = val;
+    MARK_WRITE(gb, addr);
+  }
+  else if (addr < 0x8000)
+    write_mbc1(gb, addr, val);
+  else
+    write_io(gb, addr, val);
+}
+
+static inline void mbc2_write(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  uint8_t *page = gb->mmu.write_page[addr >> 8];
+  if (page)
+  {
+    page[addr & 0xFF] = val;
+    MARK_WRITE(gb, addr);
+  }
+  else if (addr < 0x8000)
+    write_mbc2(gb, addr, val);
+  else
+    write_io(gb, addr, val);
+}
+
+#define FETCH() bus_read(gb, pc++)
+
+static inline uint16_t fetch_word(GbContext *gb, uint16_t *pc)
+{
+  uint16_t lo = bus_read(gb, (*pc)++);
+  uint16_t hi = bus_read(gb, (*pc)++);
+  return (hi << 8) | lo;
+}
+
+#define FETCH16() fetch_word(gb, &pc)
+
+#define PUSH(v) do { uint16_t p_ = (v); sp--; CORE_WRITE(gb, sp, p_ >> 8); sp--; CORE_WRITE(gb, sp, p_ & 0xFF); } while (0)
+#define POP(dst) do { dst = (bus_read(gb, sp + 1) << 8) | bus_read(gb, sp); sp += 2; } while (0)
+
+#define INC8(x) do { x++; f = (f & FLAG_C) | (x ? 0 : FLAG_Z) | ((x & 0xF) ? 0 : FLAG_H); } while (0)
+#define DEC8(x) do { x--; f = (f & FLAG_C) | FLAG_N | (x ? 0 : FLAG_Z) | (((x & 0xF) == 0xF) ? FLAG_H : 0); } while (0)
+
+#define ADD8(v) do { uint8_t v_ = (v); uint8_t r_ = a + v_; \
+  f = (r_ ? 0 : FLAG_Z) | ((((a & 0xF) + (v_ & 0xF)) & 0x10) ? FLAG_H : 0) \
+    | ((((uint16_t)a + v_) > 255) ? FLAG_C : 0); \
+  a = r_; } while (0)
+
+#define ADC8(v) do { uint8_t v_ = (v); uint8_t cy_ = (f & FLAG_C) ? 1 : 0; uint8_t r_ = a + v_ + cy_; \
+  f = (r_ ? 0 : FLAG_Z) | ((((a & 0xF) + (v_ & 0xF) + cy_) > 0xF) ? FLAG_H : 0) \
+    | ((((uint16_t)a + v_ + cy_) > 0xFF) ? FLAG_C : 0); \
+  a = r_; } while (0)
+
+#define CP8(v) do { uint8_t v_ = (v); uint8_t r_ = a - v_; \
+  f = FLAG_N | (r_ ? 0 : FLAG_Z) | ((a < v_) ? FLAG_C : 0) \
+    | (((r_ & 0xF) > (a & 0xF)) ? FLAG_H : 0); } while (0)
+
+#define SUB8(v) do { uint8_t w_ = (v); CP8(w_); a -= w_; } while (0)
+
+#define SBC8(v) do { uint8_t v_ = (v); uint8_t cy_ = (f & FLAG_C) ? 1 : 0; uint8_t r_ = a - v_ - cy_; \
+  f = FLAG_N | (r_ ? 0 : FLAG_Z) | (((a & 0xF) < ((v_ & 0xF) + cy_)) ? FLAG_H : 0) \
+    | ((a < (v_ + cy_)) ? FLAG_C : 0); \
+  a = r_; } while (0)
+
+#define AND8(v) do { a &= (v); f = (a ? 0 : FLAG_Z) | FLAG_H; } while (0)
+#define XOR8(v) do { a ^= (v); f = (a ? 0 : FLAG_Z); } while (0)
+#define OR8(v) do { a |= (v); f = (a ? 0 : FLAG_Z); } while (0)
+
+#define ADD16(v) do { uint16_t hl_ = REG_HL; uint32_t r_ = (uint32_t)hl_ + (v); \
+  f = (f & FLAG_Z) | (((hl_ & 0xFFF) > (r_ & 0xFFF)) ? FLAG_H : 0) | ((r_ > 0xFFFF) ? FLAG_C : 0); \
+  SET_HL(r_); } while (0)
+
+#define JR(cond) do { int8_t o_ = FETCH(); if (cond) pc += o_; m = 2; } while (0)
+#define JP(cond) do { uint16_t a_ = FETCH16(); if (cond) pc = a_; m = 3; } while (0)
+#define CALL(cond) do { uint16_t a_ = FETCH16(); if (cond) { PUSH(pc); pc = a_; } m = 3; } while (0)
+#define RET(cond) do { if (cond) POP(pc); m = 1; } while (0)
+#define RST(addr) do { PUSH(pc); pc = (addr); m = 1; } while (0)
+
+// IF, IE and IME are only looked at when something changed one of them
+#define CHECK_INTERUPT() scheduler_schedule(&gb->scheduler, EVENT_INTERUPT, gb->clock.cycles)
+
+// Register operand by opcode index: B C D E H L (HL) A
+#define GET_R8(i, hl_read) ((i) == 0 ? b : (i) == 1 ? c : (i) == 2 ? d : (i) == 3 ? e \
+  : (i) == 4 ? h : (i) == 5 ? l : (i) == 6 ? (hl_read) : a)
+
+#define SET_R8(i, v) do { switch (i) { \
+  case 0: b = (v); break; case 1: c = (v); break; case 2: d = (v); break; \
+  case 3: e = (v); break; case 4: h = (v); break; case 5: l = (v); break; \
+  case 6: gb->mmu.memory[REG_HL] = (v); MARK_DIRTY(gb, REG_HL); TILE_WRITE(gb, REG_HL); PALETTE_WRITE(gb, REG_HL); break; default: a = (v); break; } } while (0)
+
+#define ALU_BLOCK(base, OP) \
+  case base + 0: OP(b); m = 1; break; \
+  case base + 1: OP(c); m = 1; break; \
+  case base + 2: OP(d); m = 1; break; \
+  case base + 3: OP(e); m = 1; break; \
+  case base + 4: OP(h); m = 1; break; \
+  case base + 5: OP(l); m = 1; break; \
+  case base + 6: OP(bus_read(gb, REG_HL)); m = 1; break; \
+  case base + 7: OP(a); m = 1; break;
+
+#define LD_BLOCK(base, dst) \
+  case base + 0: dst = b; m = 1; break; \
+  case base + 1: dst = c; m = 1; break; \
+  case base + 2: dst = d; m = 1; break; \
+  case base + 3: dst = e; m = 1; break; \
+  case base + 4: dst = h; m = 1; break; \
+  case base + 5: dst = l; m = 1; break; \
+  case base + 6: dst = bus_read(gb, REG_HL); m = 1; break; \
+  case base + 7: dst = a; m = 1; break;
+
+static const uint16_t interupt_vectors[5] = { 0x40, 0x48, 0x50, 0, 0x60 };
+
+static uint8_t prefix_op(uint8_t op, uint8_t v, uint8_t *f)
+{
+  uint8_t y = (op >> 3) & 7;
+  uint8_t carry = *f & FLAG_C;
+
+  switch (op >> 6)
+  {
+    case 1: // BIT
+      *f = (*f & FLAG_C) | FLAG_H | ((v & (1 << y)) ? 0 : FLAG_Z);
+      return v;
+    case 2: // RES
+      return v & ~(1 << y);
+    case 3: // SET
+      return v | (1 << y);
+  }
+
+  switch (y)
+  {
+    case 0: carry = (v > 0x7F) ? FLAG_C : 0; v = (v << 1) | (carry ? 1 : 0); break; // RLC
+    case 1: carry = (v & 1) ? FLAG_C : 0; v = (carry ? 0x80 : 0) | (v >> 1); break; // RRC
+    case 2: { uint8_t old = carry; carry = (v > 0x7F) ? FLAG_C : 0; v = (v << 1) | (old ? 1 : 0); break; } // RL
+    case 3: { uint8_t old = carry; carry = (v & 1) ? FLAG_C : 0; v = (old ? 0x80 : 0) | (v >> 1); break; } // RR
+    case 4: carry = (v >> 7) ? FLAG_C : 0; v <<= 1; break; // SLA
+    case 5: carry = (v & 1) ? FLAG_C : 0; v = (v & 0x80) | (v >> 1); break; // SRA
+    case 6: carry = 0; v = (v >> 4) | (v << 4); break; // SWAP
+    case 7: carry = (v & 1) ? FLAG_C : 0; v >>= 1; break; // SRL
+  }
+  *f = carry | (v ? 0 : FLAG_Z);
+  return v;
+}
+
+#define CORE_RUN run_bios
+#define CORE_WRITE bios_write
+#include "cpu_core.h"
+
+#define CORE_RUN run_rom_only
+#define CORE_WRITE rom_only_write
+#include "cpu_core.h"
+
+#define CORE_RUN run_mbc1
+#define CORE_WRITE mbc1_write
+#include "cpu_core.h"
+
+#define CORE_RUN run_mbc2
+#define CORE_WRITE mbc2_write
+#include "cpu_core.h"
+
+uint32_t cpu_run(GbContext *gb, uint8_t pixels[], int *display, uint32_t cycles)
+{
+  uint64_t start = gb->clock.cycles;
+  int events = 0;
+
+  // IME may have been changed outside of the core
+  CHECK_INTERUPT();
+  scheduler_schedule(&gb->scheduler, EVENT_STOP, start + cycles);
+
+  while (!*display && !(events & (1 << EVENT_STOP)))
+  {
+    if (gb->mmu.BIOS_MODE)
+      events = run_bios(gb, pixels, display);
+    else if (gb->mmu.mapper == MAPPER_MBC1)
+      events = run_mbc1(gb, pixels, display);
+    else if (gb->mmu.mapper == MAPPER_MBC2)
+      events = run_mbc2(gb, pixels, display);
+    else
+      events = run_rom_only(gb, pixels, display);
+  }
+
+  scheduler_cancel(&gb->scheduler, EVENT_STOP);
+  return gb->clock.cycles - start;
+}
@@ -0,0 +1,93 @@
+#include "gb.h"
+#include "cpu.h"
+
+GbContext *gb_create(char *rom_path)
+{
+  return gb_create_with_bios(rom_path, NULL);
+}
+
+GbContext *gb_create_with_bios(char *rom_path, char *bios_path)
+{
+  GbContext *gb = context_new();
+  gb->mmu.path_rom = rom_path;
+  gb->mmu.path_bios = bios_path;
+  pacer_set_speed(&gb->pacer, PACER_UNLIMITED);
+  if (init(gb))
+  {
+    context_free(gb);
+    return NULL;
+  }
+  return gb;
+}
+
+void gb_destroy(GbContext *gb)
+{
+  context_free(gb);
+}
+
+uint32_t gb_run_frame(GbContext *gb)
+{
+  uint64_t start = gb->clock.cycles;
+  int display = 0;
+
+  while (!display)
+    cpu_run(gb, gb->framebuffer, &display, FRAME_CYCLES);
+  return gb->clock.cycles - start;
+}
+
+int gb_run_cycles(GbContext *gb, uint32_t cycles)
+{
+  uint64_t end = gb->clock.cycles + cycles;
+  int frames = 0;
+
+  // cpu_run stops at every VBLANK, carry on until the deadline
+  while (gb->clock.cycles < end)
+  {
+    int display = 0;
+    cpu_run(gb, gb->framebuffer, &display, end - gb->clock.cycles);
+    frames += display;
+  }
+  return frames;
+}
+
+void gb_run_lockstep(GbContext *gbs[], int count, uint32_t frames, Gb_round_hook hook, void *arg)
+{
+  for (uint32_t frame = 0; frame < frames; frame++)
+  {
+    for (int i = 0; i < count; i++)
+      if (gbs[i])
+        gb_run_frame(gbs[i]);
+    if (hook)
+      hook(arg, frame);
+  }
+}
+
+const uint8_t *gb_framebuffer(const GbContext *gb)
+{
+  return gb->framebuffer;
+}
+
+const uint8_t *gb_screen_shades(const GbContext *gb)
+{
+  return gb->shades;
+}
+
+uint64_t gb_screen_hash(const GbContext *gb)
+{
+  uint64_t hash = 1469598103934665603ULL;
+  for (int y = 0; y < 144; y++)
+  {
+    const uint8_t *row = gb->framebuffer + y * GB_FRAMEBUFFER_PITCH;
+    for (int i = 0; i < 160 * 4; i++)
+    {
+      hash ^= row[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+void gb_set_joypad(GbContext *gb, uint8_t state)
+{
+  joypad_set(gb, state);
+}
@@ -1,231 +1,226 @@
 #include "helpers_op.h"
-
-extern Mmu MMU;
-extern Registers r;
-extern My_clock my_clock;
-extern void (*Opcodes[0x100]) (void);
-extern void (*PrefixCB[0x100]) (void);
+#include "utils.h"
 
 // Read a byte in memory and increment PC
-uint8_t read_byte(void)
+uint8_t read_byte(GbContext *gb)
 {
-  uint8_t tmp = read_memory(r.PC.val);
-  r.PC.val += 1;
+  uint8_t tmp = read_memory(gb, gb->r.PC.val);
+  gb->r.PC.val += 1;
   return tmp;
 }
 
 // Read a word in memory and increment PC by 2
-uint16_t read_word(void)
+uint16_t read_word(GbContext *gb)
 {
-  uint16_t b1 = read_byte();
-  uint16_t b2 = read_byte();
+  uint16_t b1 = read_byte(gb);
+  uint16_t b2 = read_byte(gb);
   b2 <<= 8;
   return b2 | b1;
 }
 
 // Read a byte in memory without increment PC
-uint8_t peak_byte(void)
+uint8_t peak_byte(GbContext *gb)
 {
-  return read_memory(r.PC.val);
+  return read_memory(gb, gb->r.PC.val);
 }
 
-void push_stack(const uint16_t val)
+void push_stack(GbContext *gb, const uint16_t val)
 {
-  r.SP.val -= 1;
-  write_memory(r.SP.val, val >> 8);
-  r.SP.val -= 1;
-  write_memory(r.SP.val, val & 0xFF);
+  gb->r.SP.val -= 1;
+  write_memory(gb, gb->r.SP.val, val >> 8);
+  gb->r.SP.val -= 1;
+  write_memory(gb, gb->r.SP.val, val & 0xFF);
 }
 
-uint16_t pop_stack(void)
+uint16_t pop_stack(GbContext *gb)
 {
-  uint16_t v1 = ((((uint16_t)read_memory(r.SP.val + 1)) << 8) | ((uint16_t)read_memory(r.SP.val)));
-  r.SP.val += 2;
+  uint16_t v1 = ((((uint16_t)read_memory(gb, gb->r.SP.val + 1)) << 8) | ((uint16_t)read_memory(gb, gb->r.SP.val)));
+  gb->r.SP.val += 2;
   return v1;
 }
 
-void inc_op(uint8_t *reg)
+void inc_op(GbContext *gb, uint8_t *reg)
 {
   uint8_t result = *reg + 1;
 
-  (result == 0) ? setZ() : resetZ();
-  ((result & 0xF) == 0) ? setH() : resetH();
-  resetN();
+  (result == 0) ? setZ(gb) : resetZ(gb);
+  ((result & 0xF) == 0) ? setH(gb) : resetH(gb);
+  resetN(gb);
 
   *reg = result;
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void dec_op(uint8_t *reg)
+void dec_op(GbContext *gb, uint8_t *reg)
 {
   uint8_t result = *reg - 1;
 
-  (result == 0) ? setZ() : resetZ();
-  ((result & 0xF) == 0xF) ? setH() : resetH();
-  setN();
+  (result == 0) ? setZ(gb) : resetZ(gb);
+  ((result & 0xF) == 0xF) ? setH(gb) : resetH(gb);
+  setN(gb);
 
   *reg = result;
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void pop_op(uint16_t *reg)
+void pop_op(GbContext *gb, uint16_t *reg)
 {
-  *reg = pop_stack();
+  *reg = pop_stack(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 12;
+  gb->clock.m = 1;
+  gb->clock.t = 12;
 }
 
-void push_op(const uint16_t reg)
+void push_op(GbContext *gb, const uint16_t reg)
 {
-  push_stack(reg);
+  push_stack(gb, reg);
 
-  my_clock.m = 1;
-  my_clock.t = 16;
+  gb->clock.m = 1;
+  gb->clock.t = 16;
 }
 
-void rst_op(const uint16_t addr)
+void rst_op(GbContext *gb, const uint16_t addr)
 {
-  push_stack(r.PC.val);
-  r.PC.val = addr;
+  push_stack(gb, gb->r.PC.val);
+  gb->r.PC.val = addr;
 
-  my_clock.m = 1;
-  my_clock.t = 16;
+  gb->clock.m = 1;
+  gb->clock.t = 16;
 }
 
-void swap_op(uint8_t *reg)
+void swap_op(GbContext *gb, uint8_t *reg)
 {
   *reg = ((*reg >> 4) | (*reg << 4));
 
-  (*reg == 0) ? setZ() : resetZ();
-  resetC();
-  resetN();
-  resetH();
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetC(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void adc_op(uint8_t *first, const uint8_t second)
+void adc_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
-  uint8_t result = *first + second + getC();
-  (((*first & 0xF) + (second & 0xF) + getC()) > 0xF) ? setH() : resetH();
-  (((uint16_t)*first + (uint16_t)second + (uint16_t)getC()) > 0xFF) ? setC() : resetC();
+  uint8_t result = *first + second + getC(gb);
+  (((*first & 0xF) + (second & 0xF) + getC(gb)) > 0xF) ? setH(gb) : resetH(gb);
+  (((uint16_t)*first + (uint16_t)second + (uint16_t)getC(gb)) > 0xFF) ? setC(gb) : resetC(gb);
 
-  result == 0 ? setZ() : resetZ();
-  resetN();
+  result == 0 ? setZ(gb) : resetZ(gb);
+  resetN(gb);
 
   *first = result;
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void add_8_op(uint8_t *first, const uint8_t second)
+void add_8_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
   uint8_t result = *first + second;
-  (((uint16_t)*first + (uint16_t)second) > 255) ? setC() : resetC();
+  (((uint16_t)*first + (uint16_t)second) > 255) ? setC(gb) : resetC(gb);
 
-  result == 0 ? setZ() : resetZ();
-  (((*first & 0xF) + (second & 0xF)) & 0x10) ? setH() : resetH();
-  resetN();
+  result == 0 ? setZ(gb) : resetZ(gb);
+  (((*first & 0xF) + (second & 0xF)) & 0x10) ? setH(gb) : resetH(gb);
+  resetN(gb);
 
   *first = result;
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void add_16_op(uint16_t *first, const uint16_t second)
+void add_16_op(GbContext *gb, uint16_t *first, const uint16_t second)
 {
   uint32_t result = ((uint32_t)*first + (uint32_t)second);
-  ((*first & 0xFFF) > (result & 0xFFF)) ? setH() : resetH();
-  (result > 0xFFFF) ? setC() : resetC();
-  resetN();
+  ((*first & 0xFFF) > (result & 0xFFF)) ? setH(gb) : resetH(gb);
+  (result > 0xFFFF) ? setC(gb) : resetC(gb);
+  resetN(gb);
 
   *first = (result & 0xFFFF);
 
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
-void sub_8_op(uint8_t *first, const uint8_t second)
+void sub_8_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
   uint8_t result = (*first - second);
-  (*first < second) ? setC() : resetC();
+  (*first < second) ? setC(gb) : resetC(gb);
 
-  (result == 0) ? setZ() : resetZ();
+  (result == 0) ? setZ(gb) : resetZ(gb);
 
   uint8_t testf = (result & 0xF);
   uint8_t tests = (*first & 0xF);
-  (testf > tests) ? setH() : resetH();
-  setN();
+  (testf > tests) ? setH(gb) : resetH(gb);
+  setN(gb);
 
   *first = result;
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void xor_8_op(uint8_t *first, const uint8_t second)
+void xor_8_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
   *first ^= second;
-  (*first == 0) ? setZ() : resetZ();
-  resetH();
-  resetN();
-  resetC();
+  (*first == 0) ? setZ(gb) : resetZ(gb);
+  resetH(gb);
+  resetN(gb);
+  resetC(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void and_op(uint8_t *first, const uint8_t second)
+void and_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
   *first &= second;
-  (*first == 0) ? setZ() : resetZ();
-  resetN();
-  setH();
-  resetC();
+  (*first == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  setH(gb);
+  resetC(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void or_op(uint8_t *first, const uint8_t second)
+void or_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
   *first |= second;
-  (*first == 0) ? setZ() : resetZ();
-  resetN();
-  resetH();
-  resetC();
+  (*first == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  resetH(gb);
+  resetC(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void cp_op(const uint8_t first, const uint8_t second)
+void cp_op(GbContext *gb, const uint8_t first, const uint8_t second)
 {
   uint8_t tmp = first;
-  sub_8_op(&tmp, second);
+  sub_8_op(gb, &tmp, second);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void ret_cond_op(int cond)
+void ret_cond_op(GbContext *gb, int cond)
 {
   if (cond)
   {
-    r.PC.val = pop_stack();
-    my_clock.t = 16;
+    gb->r.PC.val = pop_stack(gb);
+    gb->clock.t = 16;
   }
   else
   {
-    my_clock.t = 8;
+    gb->clock.t = 8;
   }
-  my_clock.m = 1;
+  gb->clock.m = 1;
 }
 
-void load(uint8_t *to, const uint8_t from)
+void load(GbContext *gb, uint8_t *to, const uint8_t from)
 {
   if (!to)
   {
@@ -234,139 +229,139 @@ void load(uint8_t *to, const uint8_t from)
   }
   *to = from;
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void bit_op(const uint8_t reg, const uint8_t pos)
+void bit_op(GbContext *gb, const uint8_t reg, const uint8_t pos)
 {
-  !test_bit(reg, pos) ? setZ() : resetZ();
-  resetN();
-  setH();
+  !test_bit(reg, pos) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  setH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void res_op(uint8_t *reg, const uint8_t pos)
+void res_op(GbContext *gb, uint8_t *reg, const uint8_t pos)
 {
   *reg &= ~(1 << pos);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void set_op(uint8_t *reg, const uint8_t pos)
+void set_op(GbContext *gb, uint8_t *reg, const uint8_t pos)
 {
   *reg |= (1 << pos);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void sla_op(uint8_t *reg)
+void sla_op(GbContext *gb, uint8_t *reg)
 {
-  (*reg >> 7) ? setC() : resetC();
+  (*reg >> 7) ? setC(gb) : resetC(gb);
   *reg <<= 1;
-  (*reg == 0) ? setZ() : resetZ();
-  resetN();
-  resetH();
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void srl_op(uint8_t *reg)
+void srl_op(GbContext *gb, uint8_t *reg)
 {
-  ((*reg & 0x01) == 0x01) ? setC() : resetC();
+  ((*reg & 0x01) == 0x01) ? setC(gb) : resetC(gb);
   *reg >>= 1;
-  (*reg == 0) ? setZ() : resetZ();
-  resetN();
-  resetH();
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void rl_op(uint8_t *reg)
+void rl_op(GbContext *gb, uint8_t *reg)
 {
   uint8_t carry = (*reg > 0x7F);
-  *reg = (((*reg << 1) & 0xFF) | getC());
+  *reg = (((*reg << 1) & 0xFF) | getC(gb));
 
-  carry ? setC() : resetC();
-  (*reg == 0) ? setZ() : resetZ();
-  resetN();
-  resetH();
+  carry ? setC(gb) : resetC(gb);
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void rr_op(uint8_t *reg)
+void rr_op(GbContext *gb, uint8_t *reg)
 {
   uint8_t old_0 = ((*reg & 0x01) == 0x01);
-  *reg = ((getC() ? 0x80 : 0) | (*reg >> 1));
+  *reg = ((getC(gb) ? 0x80 : 0) | (*reg >> 1));
 
-  old_0 ? setC() : resetC();
-  (*reg == 0) ? setZ() : resetZ();
-  resetN();
-  resetH();
+  old_0 ? setC(gb) : resetC(gb);
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void sbc_op(uint8_t *first, const uint8_t second)
+void sbc_op(GbContext *gb, uint8_t *first, const uint8_t second)
 {
-  uint8_t result = (*first - second - getC());
+  uint8_t result = (*first - second - getC(gb));
 
   uint16_t testf = (*first & 0xF);
   uint16_t tests = (second & 0xF);
-  (testf < (tests + getC())) ? setH() : resetH();
-  (*first < (second + getC())) ? setC() : resetC();
+  (testf < (tests + getC(gb))) ? setH(gb) : resetH(gb);
+  (*first < (second + getC(gb))) ? setC(gb) : resetC(gb);
 
-  (result == 0) ? setZ() : resetZ();
-  setN();
+  (result == 0) ? setZ(gb) : resetZ(gb);
+  setN(gb);
 
   *first = result;
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-void sra_op(uint8_t *reg)
+void sra_op(GbContext *gb, uint8_t *reg)
 {
-  ((*reg & 0x01) == 0x01) ? setC() : resetC();
+  ((*reg & 0x01) == 0x01) ? setC(gb) : resetC(gb);
   *reg = ((*reg & 0x80) | (*reg >> 1));
 
-  (*reg == 0) ? setZ() : resetZ();
-  resetN();
-  resetH();
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void rlc_op(uint8_t *reg)
+void rlc_op(GbContext *gb, uint8_t *reg)
 {
-  (*reg > 0x7F) ? setC() : resetC();
-  *reg = (((*reg << 1) & 0xFF) | getC());
-  (*reg == 0) ? setZ() : resetZ();
-  resetH();
-  resetN();
+  (*reg > 0x7F) ? setC(gb) : resetC(gb);
+  *reg = (((*reg << 1) & 0xFF) | getC(gb));
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetH(gb);
+  resetN(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void rrc_op(uint8_t *reg)
+void rrc_op(GbContext *gb, uint8_t *reg)
 {
-  ((*reg & 0x01) == 0x01) ? setC() : resetC();
-	*reg = ((getC() ? 0x80 : 0) | (*reg >> 1));
+  ((*reg & 0x01) == 0x01) ? setC(gb) : resetC(gb);
+	*reg = ((getC(gb) ? 0x80 : 0) | (*reg >> 1));
 
-  (*reg == 0) ? setZ() : resetZ();
-  resetH();
-  resetN();
+  (*reg == 0) ? setZ(gb) : resetZ(gb);
+  resetH(gb);
+  resetN(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
@@ -0,0 +1,57 @@
+#include "input.h"
+#include "utils.h"
+#include <SDL2/SDL.h>
+
+// Keyboard key for each joypad bit: Right, Left, Up, Down, A, B, Select, Start
+static const SDL_Scancode keymap[8] =
+{
+  SDL_SCANCODE_RIGHT,
+  SDL_SCANCODE_LEFT,
+  SDL_SCANCODE_UP,
+  SDL_SCANCODE_DOWN,
+  SDL_SCANCODE_A,
+  SDL_SCANCODE_S,
+  SDL_SCANCODE_SPACE,
+  SDL_SCANCODE_RETURN
+};
+
+static int polls_per_frame = 1;
+
+void input_set_rate(int rate)
+{
+  if (rate > 0)
+    polls_per_frame = rate;
+}
+
+// Cycles to run between two polls, a frame by default so input is never
+// more than one frame late.
+uint32_t input_poll_cycles(void)
+{
+  return FRAME_CYCLES / polls_per_frame;
+}
+
+// Pump the SDL events and update the joypad from the keyboard state.
+// Returns 1 when the user asked to quit.
+int input_poll(GbContext *gb)
+{
+  SDL_PumpEvents();
+  const Uint8 *state = SDL_GetKeyboardState(NULL);
+
+  uint8_t joypad = 0xFF;
+  for (int i = 0; i < 8; i++)
+  {
+    if (state[keymap[i]])
+      joypad &= ~(1 << i);
+  }
+  joypad_set(gb, joypad);
+
+  if (state[SDL_SCANCODE_ESCAPE])
+    exit(1);
+  return state[SDL_SCANCODE_Q];
+}
+
+// Rewind is held down
+int input_rewind(void)
+{
+  return SDL_GetKeyboardState(NULL)[SDL_SCANCODE_BACKSPACE];
+}
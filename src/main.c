@@ -5,20 +5,35 @@
 #include <sys/time.h>
 #include "utils.h"
 #include "vram.h"
+#include "cpu.h"
+#include "gb.h"
+#include "input.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 
 void handleInterupt(int nb);
-void keyPressed(int key);
-void keyReleased(int key);
-void print_joypad(SDL_Renderer *renderer, SDL_Texture *imgs[], SDL_Rect rects[]);
+void host_sleep(GbContext *gb, uint64_t ns);
+void print_memory_usage(GbContext *gb);
+void print_joypad(GbContext *gb, SDL_Renderer *renderer, SDL_Texture *imgs[], SDL_Rect rects[]);
 
 static int trace = 0;
 static int debug = 0;
 static int sdl = 0;
+static int power_save = 0;
+static int mem_usage = 0;
+static int pacing_stats = 0;
+static int rewind_seconds = 0;
+static int run_ahead = 0;
+static char *record_path = NULL;
+static char *replay_path = NULL;
+static uint32_t replay_frames = 0;
 static int WIDTH = (160 + 320) * 2;
 static int HEIGHT = 144 * 2 + 100;
 
+// Debugger panel next to the screen, shown with --debug
+static SDL_Texture *vram_texture = NULL;
+static uint8_t vram_view[VRAM_VIEW_WIDTH * VRAM_VIEW_HEIGHT * 4];
+
 int is_breakpoint(const int16_t breakpoints[100], const uint16_t addr)
 {
   for (int i = 0; i < 100; i++)
@@ -31,7 +46,7 @@ int is_breakpoint(const int16_t breakpoints[100], const uint16_t addr)
   return 0;
 }
 
-void print_screen(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[]
+void print_screen(GbContext *gb, SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[]
                   , SDL_Texture *imgs[], SDL_Rect rects[])
 {
   SDL_UpdateTexture
@@ -39,7 +54,7 @@ void print_screen(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[]
       texture,
       NULL,
       &pixels[0],
-      WIDTH * 4
+      SCREEN_WIDTH * 4
       );
 
   SDL_Rect src_rect = {0, 0, 160, 144};
@@ -52,67 +67,58 @@ void print_screen(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[]
   SDL_RenderFillRect(renderer, &rect);
   SDL_RenderFillRect(renderer, &rect2);
 
-  print_joypad(renderer, imgs, rects);
-  //print_vram(renderer);
+  print_joypad(gb, renderer, imgs, rects);
+  if (vram_texture)
+  {
+    memset(vram_view, 255, sizeof(vram_view));
+    print_vram(gb, vram_view);
+    SDL_UpdateTexture(vram_texture, NULL, vram_view, VRAM_VIEW_WIDTH * 4);
+    SDL_Rect vram_rect = {160, 0, VRAM_VIEW_WIDTH, VRAM_VIEW_HEIGHT};
+    SDL_RenderCopy(renderer, vram_texture, NULL, &vram_rect);
+  }
 
   SDL_RenderSetScale(renderer, 2, 2);
   SDL_RenderPresent(renderer);
 }
 
-void debug_mode(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[], int16_t* breakpoints
+void debug_mode(GbContext *gb, SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[], int16_t* breakpoints
               , SDL_Texture *imgs[], SDL_Rect rects[])
 {
   char input[10];
-  printf("0x%x(0x%x)> ", r.PC.val, peak_byte());
+  printf("0x%x(0x%x)> ", gb->r.PC.val, peak_byte(gb));
   fgets(input, 100, stdin);
 
   if (strcmp(input, "r\n") == 0)
   {
     while (1)
     {
-      uint8_t op = read_byte();
-      if (MMU.HALT)
-        r.PC.val--;
+      uint8_t op = read_byte(gb);
+      if (gb->mmu.HALT)
+        gb->r.PC.val--;
 
       //if (op == 0xfb)
       //{
-      //  r.PC.val--;
+      //  gb->r.PC.val--;
       //  break;
       //}
 
-      if (trace && !MMU.BIOS_MODE)
+      if (trace && !gb->mmu.BIOS_MODE)
       {
-        printf("At 0x%x : 0x%x\n", r.PC.val - 1, op);
-        print_r();
+        printf("At 0x%x : 0x%x\n", gb->r.PC.val - 1, op);
+        print_r(gb);
       }
       int a = 0;
-      execute(op, pixels, &a);
+      execute(gb, op, pixels, &a);
 
       if (renderer && a)
       {
-        SDL_PumpEvents();
-        print_screen(renderer, texture, pixels, imgs, rects);
-      }
-
-      if (renderer)
-      {
-        const Uint8 *state = SDL_GetKeyboardState(NULL);
-        state[SDL_SCANCODE_A] ? keyPressed(4) : keyReleased(4);
-        state[SDL_SCANCODE_S] ? keyPressed(5) : keyReleased(5);
-        state[SDL_SCANCODE_RETURN] ? keyPressed(7) : keyReleased(7);
-        state[SDL_SCANCODE_SPACE] ? keyPressed(6) : keyReleased(6);
-        state[SDL_SCANCODE_LEFT] ? keyPressed(1) : keyReleased(1);
-        state[SDL_SCANCODE_RIGHT] ? keyPressed(0) : keyReleased(0);
-        state[SDL_SCANCODE_UP] ? keyPressed(2) : keyReleased(2);
-        state[SDL_SCANCODE_DOWN] ? keyPressed(3) : keyReleased(3);
-        if (state[SDL_SCANCODE_Q])
+        print_screen(gb, renderer, texture, pixels, imgs, rects);
+        if (input_poll(gb))
           break;
-        if (state[SDL_SCANCODE_ESCAPE])
-          exit(1);
       }
-      do_interupt();
+      do_interupt(gb);
 
-      if (is_breakpoint(breakpoints, r.PC.val))
+      if (is_breakpoint(breakpoints, gb->r.PC.val))
       {
         printf("Breakpoint reached.\n");
         break;
@@ -121,33 +127,33 @@ void debug_mode(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[],
   }
   else if (strcmp(input, "n\n") == 0)
   {
-    printf("%x -> ", r.PC.val);
-    uint8_t op = read_byte();
+    printf("%x -> ", gb->r.PC.val);
+    uint8_t op = read_byte(gb);
     printf("%x\n", op);
 
     int a = 0;
-    execute(op, pixels, &a);
+    execute(gb, op, pixels, &a);
     if (renderer && a)
     {
       SDL_PumpEvents();
-      print_screen(renderer, texture, pixels, imgs, rects);
+      print_screen(gb, renderer, texture, pixels, imgs, rects);
     }
 
-    do_interupt();
-    print_r();
+    do_interupt(gb);
+    print_r(gb);
   }
   else if (strcmp(input, "show reg\n") == 0)
   {
-    print_r();
+    print_r(gb);
   }
   else if (strcmp(input, "show rom\n") == 0)
   {
-    for (int32_t j = r.PC.val - 10; j <= r.PC.val + 10; j++)
+    for (int32_t j = gb->r.PC.val - 10; j <= gb->r.PC.val + 10; j++)
     {
-      if (j == r.PC.val)
+      if (j == gb->r.PC.val)
         printf("-> ");
       if (j >= 0)
-        printf("%2x \n", MMU.memory[j]);
+        printf("%2x \n", read_memory(gb, j));
     }
   }
   else if (strcmp(input, "show tilemap\n") == 0)
@@ -155,7 +161,7 @@ void debug_mode(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[],
     int i = 0;
     for (uint16_t j = 0x9800; j <= 0x9BFF; j++)
     {
-      printf("%2x ", MMU.memory[j]);
+      printf("%2x ", gb->mmu.memory[j]);
       i++;
       if (i % 32 == 0)
         printf("\n");
@@ -196,46 +202,60 @@ void debug_mode(SDL_Renderer *renderer, SDL_Texture *texture, uint8_t pixels[],
   }
 }
 
-void keyPressed(int key)
-{
-  if (key <= -1)
-    return;
-
-  int unset = !test_bit(r.joypad, key);
-  r.joypad &= ~(1 << key);
-
-  int button = key > 3;
-  uint8_t keyReq = MMU.memory[0xFF00];
-
-  int requestInterupt = (button && !test_bit(keyReq, 5)) || (!button && !test_bit(keyReq, 4));
-  if (requestInterupt && !unset)
-    request_interupt(4);
-}
-
-void keyReleased(int key)
+// Power saving: sleep while the guest is halted, but wake up early on input
+void host_sleep(GbContext *gb, uint64_t ns)
 {
-  if (key == -1)
+  if (sdl && ns >= 1000000)
+  {
+    // Input is only read between frames while recording a movie
+    if (SDL_WaitEventTimeout(NULL, ns / 1000000) && !record_path)
+      input_poll(gb);
     return;
+  }
 
-  r.joypad |= (1 << key);
+  struct timespec t;
+  t.tv_sec = ns / 1000000000L;
+  t.tv_nsec = ns % 1000000000L;
+  nanosleep(&t, NULL);
 }
 
-void print_joypad(SDL_Renderer *renderer, SDL_Texture *imgs[], SDL_Rect rects[])
+void print_joypad(GbContext *gb, SDL_Renderer *renderer, SDL_Texture *imgs[], SDL_Rect rects[])
 {
-  if (!test_bit(r.joypad, 0))
+  if (!test_bit(gb->r.joypad, 0))
     SDL_RenderCopy(renderer, imgs[0], NULL, &rects[0]);
-  else if (!test_bit(r.joypad, 1))
+  else if (!test_bit(gb->r.joypad, 1))
     SDL_RenderCopy(renderer, imgs[1], NULL, &rects[1]);
-  else if (!test_bit(r.joypad, 2))
+  else if (!test_bit(gb->r.joypad, 2))
     SDL_RenderCopy(renderer, imgs[2], NULL, &rects[2]);
-  else if (!test_bit(r.joypad, 3))
+  else if (!test_bit(gb->r.joypad, 3))
     SDL_RenderCopy(renderer, imgs[3], NULL, &rects[3]);
   else
     SDL_RenderCopy(renderer, imgs[8], NULL, &rects[8]);
 }
 
-void handle_args(int argc, char *args[])
+// What this instance allocates. A ROM mapped from its file is shared with
+// every instance of the same file and only read in as the game touches it,
+// it is counted apart.
+void print_memory_usage(GbContext *gb)
 {
+  size_t context = sizeof(GbContext);
+  size_t screen = SCREEN_WIDTH * SCREEN_HEIGHT * 4 + SCREEN_WIDTH * SCREEN_HEIGHT;
+  size_t rom = gb->mmu.rom_mapped ? 0 : gb->mmu.rom_size;
+  size_t ram = gb->mmu.ram_size;
+
+  printf("Instance memory: %zu KiB\n", (context + screen + rom + ram) / 1024);
+  printf("  context %zu KiB, screen buffers %zu KiB, cartridge RAM %zu KiB\n",
+         context / 1024, screen / 1024, ram / 1024);
+  if (gb->mmu.rom_mapped)
+    printf("  ROM %u KiB mapped from the file, shared\n", gb->mmu.rom_size / 1024);
+  else
+    printf("  ROM %zu KiB copied\n", rom / 1024);
+}
+
+void handle_args(GbContext *gb, int argc, char *args[])
+{
+  int speed_set = 0;
+
   for (int i = 1; i < argc; i++)
   {
     if (strcmp(args[i], "--debug") == 0)
@@ -244,10 +264,68 @@ void handle_args(int argc, char *args[])
       sdl = 1;
     else if (strcmp(args[i], "--trace") == 0)
       trace = 1;
+    else if (strcmp(args[i], "--power-save") == 0)
+      power_save = 1;
+    else if (strcmp(args[i], "--cpu-usage") == 0)
+      set_cpu_report(gb, 1);
+    else if (strcmp(args[i], "--mem-usage") == 0)
+      mem_usage = 1;
+    else if (strcmp(args[i], "--unlimited") == 0)
+    {
+      pacer_set_speed(&gb->pacer, PACER_UNLIMITED);
+      speed_set = 1;
+    }
+    else if (strcmp(args[i], "--speed") == 0)
+    {
+      pacer_set_speed(&gb->pacer, atof(args[i + 1]));
+      speed_set = 1;
+      i++;
+    }
+    else if (strcmp(args[i], "--pacing-stats") == 0)
+      pacing_stats = 1;
+    else if (strcmp(args[i], "--rewind") == 0)
+    {
+      rewind_seconds = atoi(args[i + 1]);
+      i++;
+    }
+    else if (strcmp(args[i], "--run-ahead") == 0)
+    {
+      run_ahead = strcmp(args[i + 1], "auto") ? atoi(args[i + 1]) : RUNAHEAD_AUTO;
+      i++;
+    }
+    else if (strcmp(args[i], "--record") == 0)
+    {
+      record_path = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--replay") == 0)
+    {
+      replay_path = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--frames") == 0)
+    {
+      replay_frames = strtoul(args[i + 1], NULL, 10);
+      i++;
+    }
+    else if (strcmp(args[i], "--palette") == 0)
+    {
+      if (palette_set_scheme(gb, args[i + 1]))
+      {
+        printf("Unknown palette: %s (grey, dmg or pocket)\n", args[i + 1]);
+        exit(1);
+      }
+      i++;
+    }
+    else if (strcmp(args[i], "--input-rate") == 0)
+    {
+      input_set_rate(atoi(args[i + 1]));
+      i++;
+    }
     else if (strcmp(args[i], "--rom") == 0)
     {
-      MMU.path_rom = malloc(strlen(args[i + 1]) + 1);
-      memcpy(MMU.path_rom, args[i + 1], strlen(args[i + 1]) + 1);
+      gb->mmu.path_rom = malloc(strlen(args[i + 1]) + 1);
+      memcpy(gb->mmu.path_rom, args[i + 1], strlen(args[i + 1]) + 1);
       i++;
     }
     else
@@ -256,16 +334,54 @@ void handle_args(int argc, char *args[])
       exit(1);
     }
   }
+
+  if (record_path && rewind_seconds)
+  {
+    printf("--record can't be used with --rewind\n");
+    exit(1);
+  }
+  // Replays are headless and run flat out unless a speed is given
+  if (replay_path)
+  {
+    sdl = 0;
+    if (!speed_set)
+      pacer_set_speed(&gb->pacer, PACER_UNLIMITED);
+  }
+}
+
+// Feed a movie to the machine, the input changes only between frames so
+// the run is the same every time. Prints what regression runs compare.
+void replay_movie(GbContext *gb)
+{
+  Movie movie;
+  if (movie_load(&movie, replay_path))
+    exit(1);
+
+  uint32_t frames = replay_frames ? replay_frames : movie_length(&movie);
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t frame = 0; frame < frames; frame++)
+  {
+    gb_set_joypad(gb, movie_input(&movie, frame));
+    gb_run_frame(gb);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("replay: %u frames, %llu cycles, screen %016llx, %.3fs\n", frames,
+         (unsigned long long)gb->clock.cycles, (unsigned long long)gb_screen_hash(gb), seconds);
+  movie_free(&movie);
 }
 
 int main(int argc, char *args[])
 {
-  handle_args(argc, args);
+  GbContext *gb = context_new();
+  handle_args(gb, argc, args);
 
   if (sdl)
     SDL_Init(SDL_INIT_VIDEO);
 
-  uint8_t pixels[WIDTH * HEIGHT * 4];
+  uint8_t *pixels = gb->framebuffer;
   SDL_Window* pWindow = NULL;
   SDL_Renderer *renderer = NULL;
   SDL_Texture* texture = NULL;
@@ -285,8 +401,11 @@ int main(int argc, char *args[])
         renderer,
         SDL_PIXELFORMAT_ARGB8888,
         SDL_TEXTUREACCESS_STREAMING,
-        WIDTH, HEIGHT
+        SCREEN_WIDTH, SCREEN_HEIGHT
         );
+    if (debug)
+      vram_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+          SDL_TEXTUREACCESS_STREAMING, VRAM_VIEW_WIDTH, VRAM_VIEW_HEIGHT);
 
     if (!pWindow || !renderer)
     {
@@ -304,8 +423,36 @@ int main(int argc, char *args[])
     }
   }
 
-  init();
+  if (init(gb))
+    exit(1);
+  if (mem_usage)
+    print_memory_usage(gb);
+  if (power_save)
+    set_idle_handler(gb, &host_sleep);
 
+  if (replay_path)
+  {
+    replay_movie(gb);
+    context_free(gb);
+    return 0;
+  }
+
+  // Input is read once per frame and recorded with the frame it applies to
+  Movie movie;
+  uint32_t frame = 0;
+  if (record_path)
+    movie_init(&movie);
+
+  Rewind *rw = NULL;
+  // About 64 KiB per second of history, most of it is left unused
+  if (rewind_seconds > 0)
+    rw = rewind_new(gb, rewind_seconds * 60, rewind_seconds * 0x10000);
+
+  Runahead *ra = NULL;
+  if (run_ahead)
+    ra = runahead_new(gb, run_ahead);
+
+  int rewinding = 0;
   int16_t breakpoints[100];
   for (int i = 0; i < 100; i++)
     breakpoints[i] = -1;
@@ -314,48 +461,67 @@ int main(int argc, char *args[])
   {
     if (debug)
     {
-      debug_mode(renderer, texture, pixels, &breakpoints[0], imgs, rects);
+      debug_mode(gb, renderer, texture, pixels, &breakpoints[0], imgs, rects);
     }
     else
     {
-      uint8_t op = read_byte();
-      int a = 0;
-
-      if (MMU.HALT)
+      int frames;
+      // Back one frame per frame while rewind is held, the frame before is
+      // run again to show it. The newest state is the frame on screen, it is
+      // dropped when rewind is pressed.
+      int back = rw && input_rewind();
+      if (back && !rewinding)
+        rewind_pop(rw, gb);
+      rewinding = back;
+      if (back && rewind_pop(rw, gb) == 0)
       {
-        r.PC.val--;
-        my_clock.m = 1;
-        my_clock.t = 4;
-      } else {
-        execute(op, pixels, &a);
+        gb_run_frame(gb);
+        frames = 1;
       }
-
-      if (renderer && a)
+      else
       {
-        SDL_PumpEvents();
-        print_screen(renderer, texture, pixels, imgs, rects);
+        // Run-ahead works a frame at a time, input is read between frames
+        if (ra)
+        {
+          runahead_frame(ra, gb);
+          frames = 1;
+        }
+        else if (record_path)
+        {
+          gb_run_frame(gb);
+          frames = 1;
+        }
+        else
+          frames = gb_run_cycles(gb, input_poll_cycles());
+        if (rw && frames)
+          rewind_push(rw, gb);
       }
 
-      if (renderer)
+      if (renderer && frames)
+        print_screen(gb, renderer, texture, pixels, imgs, rects);
+
+      if (renderer && input_poll(gb))
+        break;
+
+      frame += frames;
+      // Out of memory, stop and keep what was recorded so far
+      if (record_path && movie_record(&movie, frame, gb->r.joypad))
       {
-        const Uint8 *state = SDL_GetKeyboardState(NULL);
-        state[SDL_SCANCODE_A] ? keyPressed(4) : keyReleased(4);
-        state[SDL_SCANCODE_S] ? keyPressed(5) : keyReleased(5);
-        state[SDL_SCANCODE_RETURN] ? keyPressed(7) : keyReleased(7);
-        state[SDL_SCANCODE_SPACE] ? keyPressed(6) : keyReleased(6);
-        state[SDL_SCANCODE_LEFT] ? keyPressed(1) : keyReleased(1);
-        state[SDL_SCANCODE_RIGHT] ? keyPressed(0) : keyReleased(0);
-        state[SDL_SCANCODE_UP] ? keyPressed(2) : keyReleased(2);
-        state[SDL_SCANCODE_DOWN] ? keyPressed(3) : keyReleased(3);
-        if (state[SDL_SCANCODE_Q])
-          break;
-        if (state[SDL_SCANCODE_ESCAPE])
-          exit(1);
+        fprintf(stderr, "Out of memory recording %s\n", record_path);
+        break;
       }
-      do_interupt();
     }
   }
 
+  if (record_path)
+  {
+    // Without its end the movie still replays up to its last change
+    if (movie_end(&movie, frame))
+      fprintf(stderr, "Out of memory ending %s\n", record_path);
+    movie_save(&movie, record_path);
+    movie_free(&movie);
+  }
+
   if (sdl)
   {
     for (int i = 0; i < 9; i++)
@@ -365,5 +531,13 @@ int main(int argc, char *args[])
     SDL_Quit();
   }
 
+  if (pacing_stats)
+    pacer_report(&gb->pacer, stdout);
+  if (ra && pacing_stats)
+    runahead_report(ra, stdout);
+
+  runahead_free(ra);
+  rewind_free(rw);
+  context_free(gb);
   return 0;
 }
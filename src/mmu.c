@@ -1,24 +1,110 @@
-#include "mmu.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include "utils.h"
 
-void init_mmu(char *path)
+// External RAM size in bytes from the cartridge header byte 0x149
+static uint32_t header_ram_size(uint8_t code)
 {
-  memset(&MMU.memory, 0, sizeof(MMU.memory));
-  memset(&MMU.ram, 0, sizeof(MMU.ram));
-
-  load_rom(MMU.path_rom);
-  load_bios(path);
-
-  MMU.MBC1 = (MMU.memory[0x147] == 1 || MMU.memory[0x147] == 2 || MMU.memory[0x147] == 3);
-  MMU.MBC2 = (MMU.memory[0x147] == 5 || MMU.memory[0x147] == 6);
-  MMU.CUR_ROM = 1;
-  MMU.CUR_RAM = 0;
-  MMU.ROM_BANKING = 0;
-  MMU.HALT = 0;
-  MMU.MEMORY_MODEL = 1;
-  MMU.BIOS_MODE = 1;
+  switch (code)
+  {
+    case 1: return 0x800;
+    case 2: return 0x2000;
+    case 3: return 0x8000;
+    case 4: return 0x20000;
+    case 5: return 0x10000;
+  }
+  return 0;
 }
 
-void load_bios(char *path)
+int init_mmu(GbContext *gb, char *path)
+{
+  memset(&gb->mmu.memory, 0, sizeof(gb->mmu.memory));
+
+  if (load_rom(gb, gb->mmu.path_rom) || load_bios(gb, path))
+    return -1;
+
+  gb->mmu.MBC1 = (gb->mmu.game[0x147] == 1 || gb->mmu.game[0x147] == 2 || gb->mmu.game[0x147] == 3);
+  gb->mmu.MBC2 = (gb->mmu.game[0x147] == 5 || gb->mmu.game[0x147] == 6);
+  gb->mmu.mapper = gb->mmu.MBC1 ? MAPPER_MBC1 : gb->mmu.MBC2 ? MAPPER_MBC2 : MAPPER_ROM_ONLY;
+
+  // MBC2 has 512 half bytes of RAM built in, the header says 0
+  free(gb->mmu.ram);
+  gb->mmu.ram_size = gb->mmu.MBC2 ? 0x200 : header_ram_size(gb->mmu.game[0x149]);
+  gb->mmu.ram = gb->mmu.ram_size ? calloc(gb->mmu.ram_size, 1) : NULL;
+  gb->mmu.CUR_ROM = 1;
+  gb->mmu.CUR_RAM = 0;
+  gb->mmu.ROM_BANKING = 0;
+  gb->mmu.HALT = 0;
+  gb->mmu.MEMORY_MODEL = 1;
+  gb->mmu.BIOS_MODE = 1;
+  memset(gb->mmu.dirty, 1, sizeof(gb->mmu.dirty));
+  video_cache_reset(gb);
+  map_pages(gb);
+  return 0;
+}
+
+// Point every 256 bytes page that can be accessed directly at its host
+// memory. NULL pages go through read_slow and write_slow: I/O, MBC control
+// and the pages where writes have side effects or are ignored. Tile data
+// is never direct, the tile cache has to see the writes.
+void map_pages(GbContext *gb)
+{
+  for (int p = 0; p < 0x100; p++)
+  {
+    gb->mmu.read_page[p] = &gb->mmu.memory[p << 8];
+    gb->mmu.write_page[p] = gb->mmu.BIOS_MODE ? &gb->mmu.memory[p << 8] : NULL;
+    gb->mmu.dirty_page[p] = p;
+  }
+
+  // ROM bank 0, the BIOS is loaded in memory and overlays its first page
+  for (int p = gb->mmu.BIOS_MODE ? 0x01 : 0x00; p < 0x40; p++)
+    gb->mmu.read_page[p] = &gb->mmu.game[p << 8];
+
+  if (!gb->mmu.BIOS_MODE)
+  {
+    for (int p = TILE_DATA_END >> 8; p < 0xA0; p++)
+      gb->mmu.write_page[p] = &gb->mmu.memory[p << 8];
+    for (int p = 0xC0; p < 0xE0; p++)
+      gb->mmu.write_page[p] = &gb->mmu.memory[p << 8];
+  }
+
+  for (int p = 0x80; p < TILE_DATA_END >> 8; p++)
+    gb->mmu.write_page[p] = NULL;
+
+  gb->mmu.read_page[0xFF] = NULL;
+  gb->mmu.write_page[0xFF] = NULL;
+  map_banks(gb);
+}
+
+// Remap the switchable ROM and RAM banks, called on every MBC write
+void map_banks(GbContext *gb)
+{
+  // Bank numbers past the end of the cartridge wrap around
+  uint32_t rom_bank = gb->mmu.CUR_ROM % gb->mmu.rom_banks;
+  for (int p = 0x40; p < 0x80; p++)
+    gb->mmu.read_page[p] = &gb->mmu.game[rom_bank * 0x4000 + ((p - 0x40) << 8)];
+
+  for (int p = 0xA0; p < 0xC0; p++)
+  {
+    uint8_t *bank = NULL;
+    if (gb->mmu.ram_size)
+      bank = &gb->mmu.ram[(((p - 0xA0) << 8) + gb->mmu.CUR_RAM * 0x2000) % gb->mmu.ram_size];
+    gb->mmu.read_page[p] = bank;
+    gb->mmu.dirty_page[p] = bank ? 0x100 + ((bank - gb->mmu.ram) >> 8) : p;
+
+    if (gb->mmu.BIOS_MODE)
+      continue;
+    if (bank && ((gb->mmu.ENABLE_RAM && gb->mmu.MBC1) || (!gb->mmu.ENABLE_RAM && gb->mmu.MBC2 && p < 0xA2)))
+      gb->mmu.write_page[p] = bank;
+    else
+      gb->mmu.write_page[p] = NULL;
+  }
+}
+
+int load_bios(GbContext *gb, char *path)
 {
   FILE *file;
   unsigned long len;
@@ -26,212 +112,302 @@ void load_bios(char *path)
   if (!file)
   {
     fprintf(stderr, "Error loading file %s\n", path);
-    exit(1);
+    return -1;
   }
   fseek(file, 0, SEEK_END);
   len = ftell(file);
   rewind(file);
 
-  fread(&MMU.memory, len, 1, file);
+  // The boot ROM overlays the first page of the cartridge
+  if (len == 0 || len > 0x100 || fread(&gb->mmu.memory, len, 1, file) != 1)
+  {
+    fprintf(stderr, "Not a boot ROM: %s\n", path);
+    fclose(file);
+    return -1;
+  }
   fclose(file);
+  return 0;
 }
 
-void load_rom(char *path)
+static void unload_rom(GbContext *gb)
 {
-  FILE *file;
-  unsigned long len;
-  file = fopen(path, "rb");
-  if (!file)
+  if (!gb->mmu.game)
+    return;
+
+  if (gb->mmu.rom_mapped)
+    munmap((void *)gb->mmu.game, gb->mmu.rom_size);
+  else
+    free((void *)gb->mmu.game);
+  gb->mmu.game = NULL;
+}
+
+void free_mmu(GbContext *gb)
+{
+  unload_rom(gb);
+  free(gb->mmu.ram);
+  gb->mmu.ram = NULL;
+}
+
+// The ROM is served straight from a read-only mapping of the file. Nothing
+// is read from disk until the game touches a page, and every instance of
+// the same file shares the page cache. Files that are not made of whole
+// banks are copied instead.
+int load_rom(GbContext *gb, char *path)
+{
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) < 0)
   {
     fprintf(stderr, "Error loading file %s\n", path);
-    exit(1);
+    if (fd >= 0)
+      close(fd);
+    return -1;
   }
-  fseek(file, 0, SEEK_END);
-  len = ftell(file);
-  rewind(file);
+  size_t len = st.st_size;
 
-  fread(&MMU.game, len, 1, file);
-  fclose(file);
+  unload_rom(gb);
+  gb->mmu.rom_mapped = 0;
+
+  if (len >= 0x8000 && len % 0x4000 == 0)
+  {
+    void *rom = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (rom != MAP_FAILED)
+    {
+      gb->mmu.game = rom;
+      gb->mmu.rom_size = len;
+      gb->mmu.rom_mapped = 1;
+    }
+  }
 
-  memcpy(&MMU.memory, &MMU.game, 0x8000);
+  if (!gb->mmu.rom_mapped)
+  {
+    gb->mmu.rom_size = len < 0x8000 ? 0x8000 : (len + 0x3FFF) & ~0x3FFF;
+    uint8_t *rom = calloc(gb->mmu.rom_size, 1);
+    if (!rom || read(fd, rom, len) != (ssize_t)len)
+    {
+      fprintf(stderr, "Error loading file %s\n", path);
+      free(rom);
+      close(fd);
+      return -1;
+    }
+    gb->mmu.game = rom;
+  }
+
+  close(fd);
+  gb->mmu.rom_banks = gb->mmu.rom_size / 0x4000;
+  return 0;
 }
 
-void print_memory(uint16_t from, uint16_t to)
+void print_memory(GbContext *gb, uint16_t from, uint16_t to)
 {
   for (uint16_t i = from; i <=to; i++)
   {
-    printf("%x - %x\n", i, MMU.memory[i]);
+    printf("%x - %x\n", i, gb->mmu.memory[i]);
   }
 }
 
-uint8_t get_joypad(void)
+uint8_t get_joypad(GbContext *gb)
 {
-  uint8_t mem = MMU.memory[0xFF00];
+  uint8_t mem = gb->mmu.memory[0xFF00];
   mem ^= 0xFF;
 
   if (!test_bit(mem, 4))
   {
-    uint8_t joy = (r.joypad >> 4) | 0xF0;
+    uint8_t joy = (gb->r.joypad >> 4) | 0xF0;
     mem &= joy;
   }
   else if (!test_bit(mem, 5))
   {
-    uint8_t joy = (r.joypad & 0xF) | 0xF0;
+    uint8_t joy = (gb->r.joypad & 0xF) | 0xF0;
     mem &= joy;
   }
   return mem;
 }
 
-uint8_t read_memory(uint16_t addr)
+// Set the buttons state (a clear bit is a pressed button). The joypad
+// interupt is only requested for buttons that just got pressed in a
+// selected group.
+void joypad_set(GbContext *gb, uint8_t state)
 {
-  if ((addr >= 0x4000) && (addr <= 0x7FFF))
-  {
-    unsigned int new_addr = addr;
-    new_addr += ((MMU.CUR_ROM - 1) * 0x4000);
-    return MMU.game[new_addr];
-  }
-  else if ((addr >= 0xA000) && (addr <= 0xBFFF))
-  {
-    unsigned int addr2 = (addr - 0xA000) + (MMU.CUR_RAM * 0x2000);
-    return MMU.ram[addr2];
-  }
+  uint8_t pressed = gb->r.joypad & ~state;
+  gb->r.joypad = state;
+
+  uint8_t select = gb->mmu.memory[0xFF00];
+  if (((pressed & 0xF0) && !test_bit(select, 5))
+      || ((pressed & 0x0F) && !test_bit(select, 4)))
+    request_interupt(gb, 4);
+}
+
+uint8_t read_slow(GbContext *gb, uint16_t addr)
+{
+  // No external RAM on the cartridge
+  if ((addr >= 0xA000) && (addr < 0xC000))
+    return 0xFF;
 
   // Catch joypad request
   if (addr == 0xFF00)
   {
-    return get_joypad();
+    return get_joypad(gb);
   }
-  return MMU.memory[addr];
+  return gb->mmu.memory[addr];
+}
+
+uint8_t read_memory(GbContext *gb, uint16_t addr)
+{
+  const uint8_t *page = gb->mmu.read_page[addr >> 8];
+  if (page)
+    return page[addr & 0xFF];
+  return read_slow(gb, addr);
 }
 
-void write_memory(uint16_t addr, uint8_t val)
+void write_memory(GbContext *gb, uint16_t addr, uint8_t val)
 {
-  if (MMU.BIOS_MODE)
+  uint8_t *page = gb->mmu.write_page[addr >> 8];
+  if (page)
   {
-    if (addr == 0xFF50 && val == 1)
-   {
-     load_rom(MMU.path_rom);
-     MMU.BIOS_MODE = 0;
-   }
-   MMU.memory[addr] = val;
-   return;
+    page[addr & 0xFF] = val;
+    MARK_WRITE(gb, addr);
   }
+  else
+    write_slow(gb, addr, val);
+}
 
+void write_mbc1(GbContext *gb, uint16_t addr, uint8_t val)
+{
   if (addr < 0x2000)
   {
-      if (MMU.MBC1)
-	    {
-            if ((val & 0xF) == 0xA)
-                MMU.ENABLE_RAM = 1;
-            else if (val == 0x0)
-                MMU.ENABLE_RAM = 0;
-	    }
-	    else if (MMU.MBC2)
-	    {
-        //bit 0 of upper byte must be 0
-	     if (0 == test_bit(addr >> 8, 0))
-	     {
-	         if ((val & 0xF) == 0xA)
-                MMU.ENABLE_RAM = 1;
-            else if (val == 0x0)
-                MMU.ENABLE_RAM = 0;
-	     }
-	    }
-    }
-   else if ((addr >= 0x2000) && (addr < 0x4000))
-   {
-     if (MMU.MBC1)
+    if ((val & 0xF) == 0xA)
+      gb->mmu.ENABLE_RAM = 1;
+    else if (val == 0x0)
+      gb->mmu.ENABLE_RAM = 0;
+  }
+  else if (addr < 0x4000)
+  {
+    if (val == 0x00)
+      val++;
+
+    val &= 31;
+
+    // Turn off the lower 5-bits.
+    gb->mmu.CUR_ROM &= 224;
+
+    // Combine the written data with the register.
+    gb->mmu.CUR_ROM |= val;
+  }
+  else if (addr < 0x6000)
+  {
+    // are we using memory model 16/8
+    if (gb->mmu.MEMORY_MODEL)
     {
-      if (val == 0x00)
-        val++;
+      // in this mode we can only use Ram Bank 0
+      gb->mmu.CUR_RAM = 0 ;
 
-      val &= 31;
+      val &= 3;
+      val <<= 5;
+
+      if ((gb->mmu.CUR_ROM & 31) == 0)
+      {
+        val++;
+      }
 
-      // Turn off the lower 5-bits.
-      MMU.CUR_ROM &= 224;
+      // Turn off bits 5 and 6, and 7 if it somehow got turned on.
+      gb->mmu.CUR_ROM &= 31;
 
       // Combine the written data with the register.
-      MMU.CUR_ROM |= val;
+      gb->mmu.CUR_ROM |= val;
     }
-    else if (MMU.MBC2)
+    else
     {
-      val &= 0xF;
-      MMU.CUR_ROM = val;
+      gb->mmu.CUR_RAM = (val & 0x3);
     }
-   }
-   else if (((addr >= 0x4000) && (addr < 0x6000)))
-   {
-     if (MMU.MBC1)
+  }
+  else
+  {
+    // we're only interested in the first bit
+    val &= 1 ;
+    if (val == 1)
     {
-      // are we using memory model 16/8
-      if (MMU.MEMORY_MODEL)
-      {
-        // in this mode we can only use Ram Bank 0
-        MMU.CUR_RAM = 0 ;
+      gb->mmu.CUR_RAM = 0 ;
+      gb->mmu.MEMORY_MODEL = 0;
+    }
+    else
+    {
+      gb->mmu.MEMORY_MODEL = 1;
+    }
+  }
+  map_banks(gb);
+}
 
-        val &= 3;
-        val <<= 5;
+void write_mbc2(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  if (addr < 0x2000)
+  {
+    //bit 0 of upper byte must be 0
+    if (0 == test_bit(addr >> 8, 0))
+    {
+      if ((val & 0xF) == 0xA)
+        gb->mmu.ENABLE_RAM = 1;
+      else if (val == 0x0)
+        gb->mmu.ENABLE_RAM = 0;
+    }
+  }
+  else if (addr < 0x4000)
+  {
+    val &= 0xF;
+    gb->mmu.CUR_ROM = val;
+  }
+  map_banks(gb);
+}
 
-        if ((MMU.CUR_ROM & 31) == 0)
-        {
-          val++;
-        }
+// Writes while the BIOS is mapped have no side effect but FF50, which
+// unmaps it. The core is told to switch to the cartridge loop. The video
+// caches still see the tile data and palette writes.
+void write_bios(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  if (addr == 0xFF50 && val == 1)
+  {
+    gb->mmu.BIOS_MODE = 0;
+    map_pages(gb);
+    scheduler_schedule(&gb->scheduler, EVENT_MAPPER, gb->clock.cycles);
+  }
+  gb->mmu.memory[addr] = val;
+  MARK_DIRTY(gb, addr);
+  TILE_WRITE(gb, addr);
+  PALETTE_WRITE(gb, addr);
+}
 
-        // Turn off bits 5 and 6, and 7 if it somehow got turned on.
-        MMU.CUR_ROM &= 31;
+void write_slow(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  if (gb->mmu.BIOS_MODE)
+    write_bios(gb, addr, val);
+  else if (addr >= 0x8000)
+    write_io(gb, addr, val);
+  else if (gb->mmu.mapper == MAPPER_MBC1)
+    write_mbc1(gb, addr, val);
+  else if (gb->mmu.mapper == MAPPER_MBC2)
+    write_mbc2(gb, addr, val);
+}
 
-        // Combine the written data with the register.
-        MMU.CUR_ROM |= val;
+// Slow path for the pages above the ROM once the BIOS is unmapped
+void write_io(GbContext *gb, uint16_t addr, uint8_t val)
+{
+  if (addr < TILE_DATA_END)
+  {
+    gb->mmu.memory[addr] = val;
+    MARK_DIRTY(gb, addr);
+    TILE_WRITE(gb, addr);
+  }
+  // External RAM is only unmapped while it can't be written
+  else if (((addr >= 0xA000) && (addr < 0xC000)))
+  {
 
-      }
-      else
-      {
-        MMU.CUR_RAM = (val & 0x3);
-      }
-    }
-   }
-   else if (((addr >= 0x6000) && (addr < 0x8000)))
-   {
-     if (MMU.MBC1)
-    {
-      // we're only interested in the first bit
-      val &= 1 ;
-      if (val == 1)
-      {
-        MMU.CUR_RAM = 0 ;
-        MMU.MEMORY_MODEL = 0;
-      }
-      else
-      {
-        MMU.MEMORY_MODEL = 1;
-      }
-    }
-   }
- else if (((addr >= 0xA000) && (addr < 0xC000)))
-  {
-    if (MMU.ENABLE_RAM)
- 		{
- 		    if (MMU.MBC1)
- 		    {
-            uint16_t newAddress = (addr - 0xA000);
-            MMU.ram[newAddress + (MMU.CUR_RAM * 0x2000)] = val;
- 		    }
- 		}
- 		else if (MMU.MBC2 && (addr < 0xA200))
- 		{
- 		    uint16_t newAddress = (addr - 0xA000);
-        MMU.ram[newAddress + (MMU.CUR_RAM * 0x2000)] = val;
- 		}
-  }
-  // we're right to internal RAM, remember that it needs to echo it
-	else if ((addr >= 0xC000) && (addr <= 0xDFFF))
-	{
-		MMU.memory[addr] = val;
-	}
+  }
   else if ((addr >= 0xE000) && (addr < 0xFE00))
   {
-    MMU.memory[addr] = val;
-    MMU.memory[addr - 0x2000] = val;
+    gb->mmu.memory[addr] = val;
+    gb->mmu.memory[addr - 0x2000] = val;
+    MARK_DIRTY(gb, addr);
+    MARK_DIRTY(gb, addr - 0x2000);
   }
 
   // Read only
@@ -241,16 +417,27 @@ void write_memory(uint16_t addr, uint8_t val)
   }
   else if (addr == 0xFF04) // Divider register
   {
-    MMU.memory[addr] = 0;
-    my_clock.divider = 0;
+    reset_divider(gb);
+  }
+  else if (addr == 0xFF44) // LY register
+  {
+    gb->mmu.memory[addr] = 0;
+    check_coincidence(gb);
+  }
+  else if (addr == 0xFF41 || addr == 0xFF45) // STAT and LYC registers
+  {
+    gb->mmu.memory[addr] = val;
+    check_coincidence(gb);
   }
-  else if (addr == 0xFF44) // Divider register
+  else if (addr == 0xFF0F || addr == 0xFFFF) // IF and IE registers
   {
-    MMU.memory[addr] = 0;
+    gb->mmu.memory[addr] = val;
+    scheduler_schedule(&gb->scheduler, EVENT_INTERUPT, gb->clock.cycles);
   }
   else if (addr == 0xFF07) // TMC reg
   {
-    MMU.memory[addr] = val;
+    int counter = get_timer_counter(gb);
+    gb->mmu.memory[addr] = val;
     uint8_t timer = (val & 0x03);
     int clock_speed = 0;
     switch(timer)
@@ -261,40 +448,60 @@ void write_memory(uint16_t addr, uint8_t val)
       case 3: clock_speed = 256; break;
     }
 
-    if (my_clock.timer_counter != clock_speed)
+    if (counter != clock_speed)
     {
-      my_clock.timer_counter = 0;
-      my_clock.clock_speed= clock_speed;
+      counter = 0;
+      gb->clock.clock_speed= clock_speed;
     }
+    set_timer_counter(gb, counter);
+  }
+  else if (addr >= 0xFF47 && addr <= 0xFF49) // BGP, OBP0 and OBP1
+  {
+    gb->mmu.memory[addr] = val;
+    MARK_DIRTY(gb, addr);
+    palette_update(gb, addr);
   }
   else if (addr == 0xFF46)
   {
+    // The source is read as the CPU sees it, ROM and external RAM banks
+    // are not in the memory map
     uint16_t address = val << 8;
-    for (int i = 0 ; i < 0xA0; i++)
+    const uint8_t *page = gb->mmu.read_page[val];
+    if (page)
+      memcpy(&gb->mmu.memory[0xFE00], page, 0xA0);
+    else
     {
-      MMU.memory[0xFE00 + i] = MMU.memory[address + i];
+      for (int i = 0 ; i < 0xA0; i++)
+        gb->mmu.memory[0xFE00 + i] = read_memory(gb, address + i);
     }
+    MARK_DIRTY(gb, 0xFE00);
   }
   else
   {
-      MMU.memory[addr] = val;
+      gb->mmu.memory[addr] = val;
+      MARK_DIRTY(gb, addr);
   }
 }
 
-void request_interupt(uint8_t val)
+void request_interupt(GbContext *gb, uint8_t val)
 {
   // printf("Request interupt: %u\n", val);
-  uint8_t mem = MMU.memory[0xFF0F];
+  uint8_t mem = gb->mmu.memory[0xFF0F];
   mem |= (1 << val);
-  MMU.memory[0xFF0F] =  mem;
+  gb->mmu.memory[0xFF0F] =  mem;
+  scheduler_schedule(&gb->scheduler, EVENT_INTERUPT, gb->clock.cycles);
 }
 
-void do_interupt(void)
+void do_interupt(GbContext *gb)
 {
-  if (r.ime)
+  // An enabled interupt ends HALT even when IME is off
+  if (gb->mmu.memory[0xFF0F] & gb->mmu.memory[0xFFFF] & 0x1F)
+    gb->mmu.HALT = 0;
+
+  if (gb->r.ime)
   {
-    uint8_t mem = MMU.memory[0xFF0F];
-    uint8_t ena = MMU.memory[0xFFFF];
+    uint8_t mem = gb->mmu.memory[0xFF0F];
+    uint8_t ena = gb->mmu.memory[0xFFFF];
     if (mem > 0)
     {
         for (uint8_t i = 0; i < 5; i++)
@@ -302,7 +509,7 @@ void do_interupt(void)
           if (test_bit(mem, i) && test_bit(ena, i))
           {
             // printf("Execute interupt: %u\n", i);
-            execute_interupt(i);
+            execute_interupt(gb, i);
             return;
           }
         }
@@ -310,21 +517,21 @@ void do_interupt(void)
   }
 }
 
-void execute_interupt(uint8_t i)
+void execute_interupt(GbContext *gb, uint8_t i)
 {
-  MMU.HALT = 0;
-  r.ime = 0;
+  gb->mmu.HALT = 0;
+  gb->r.ime = 0;
 
-  uint8_t mem = MMU.memory[0xFF0F];
+  uint8_t mem = gb->mmu.memory[0xFF0F];
   mem &= ~(1 << i);
-  MMU.memory[0xFF0F] = mem;
+  gb->mmu.memory[0xFF0F] = mem;
 
-  push_stack(r.PC.val);
+  push_stack(gb, gb->r.PC.val);
   switch (i)
   {
-    case 0: r.PC.val = 0x40; break;
-    case 1: r.PC.val = 0x48; break;
-    case 2: r.PC.val = 0x50; break;
-    case 4: r.PC.val = 0x60; break;
+    case 0: gb->r.PC.val = 0x40; break;
+    case 1: gb->r.PC.val = 0x48; break;
+    case 2: gb->r.PC.val = 0x50; break;
+    case 4: gb->r.PC.val = 0x60; break;
   }
 }
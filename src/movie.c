@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "movie.h"
+
+void movie_init(Movie *m)
+{
+  memset(m, 0, sizeof(*m));
+  m->joypad = 0xFF;
+}
+
+// Returns -1, the movie unchanged, when there is no memory left
+static int append(Movie *m, uint32_t frame, uint8_t joypad)
+{
+  if (m->count == m->capacity)
+  {
+    uint32_t capacity = m->capacity ? m->capacity * 2 : 64;
+    MovieEvent *events = realloc(m->events, capacity * sizeof(MovieEvent));
+    if (!events)
+      return -1;
+    m->events = events;
+    m->capacity = capacity;
+  }
+  m->events[m->count].frame = frame;
+  m->events[m->count].joypad = joypad;
+  m->count++;
+  return 0;
+}
+
+// Returns 0 on success, -1 if the file is missing or not a movie. Frames
+// must not go backwards from one record to the next.
+int movie_load(Movie *m, const char *path)
+{
+  movie_init(m);
+
+  FILE *file = fopen(path, "rb");
+  if (!file)
+  {
+    fprintf(stderr, "Error loading movie %s\n", path);
+    return -1;
+  }
+
+  uint8_t header[5];
+  if (fread(header, sizeof(header), 1, file) != 1 || memcmp(header, "GBMV", 4)
+      || header[4] != MOVIE_VERSION)
+  {
+    fprintf(stderr, "Not a movie: %s\n", path);
+    fclose(file);
+    return -1;
+  }
+
+  uint8_t record[5];
+  while (fread(record, sizeof(record), 1, file) == 1)
+  {
+    uint32_t frame = record[0] | (record[1] << 8) | (record[2] << 16)
+      | ((uint32_t)record[3] << 24);
+    if (m->count && frame < m->events[m->count - 1].frame)
+    {
+      fprintf(stderr, "Movie %s goes back to frame %u\n", path, frame);
+      fclose(file);
+      movie_free(m);
+      return -1;
+    }
+    if (append(m, frame, record[4]))
+    {
+      fprintf(stderr, "Out of memory loading movie %s\n", path);
+      fclose(file);
+      movie_free(m);
+      return -1;
+    }
+  }
+
+  fclose(file);
+  return 0;
+}
+
+void movie_free(Movie *m)
+{
+  free(m->events);
+  m->events = NULL;
+  m->count = 0;
+  m->capacity = 0;
+}
+
+// Joypad state for `frame`. Frames must be asked for in increasing order,
+// each call only looks at the events since the previous one.
+uint8_t movie_input(Movie *m, uint32_t frame)
+{
+  while (m->cursor < m->count && m->events[m->cursor].frame <= frame)
+    m->joypad = m->events[m->cursor++].joypad;
+  return m->joypad;
+}
+
+int movie_record(Movie *m, uint32_t frame, uint8_t joypad)
+{
+  uint8_t last = m->count ? m->events[m->count - 1].joypad : 0xFF;
+  if (joypad != last)
+    return append(m, frame, joypad);
+  return 0;
+}
+
+int movie_end(Movie *m, uint32_t frame)
+{
+  uint8_t last = m->count ? m->events[m->count - 1].joypad : 0xFF;
+  return append(m, frame, last);
+}
+
+int movie_save(const Movie *m, const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (!file)
+  {
+    fprintf(stderr, "Error saving movie %s\n", path);
+    return -1;
+  }
+
+  uint8_t header[5] = { 'G', 'B', 'M', 'V', MOVIE_VERSION };
+  fwrite(header, sizeof(header), 1, file);
+  for (uint32_t i = 0; i < m->count; i++)
+  {
+    uint32_t frame = m->events[i].frame;
+    uint8_t record[5] = { frame, frame >> 8, frame >> 16, frame >> 24, m->events[i].joypad };
+    fwrite(record, sizeof(record), 1, file);
+  }
+  return fclose(file) ? -1 : 0;
+}
+
+uint32_t movie_length(const Movie *m)
+{
+  return m->count ? m->events[m->count - 1].frame : 0;
+}
@@ -0,0 +1,113 @@
+#include <errno.h>
+#include <string.h>
+#include "pacer.h"
+#include "utils.h"
+
+static int64_t elapsed_ns(const struct timespec *from, const struct timespec *to)
+{
+  return (to->tv_sec - from->tv_sec) * 1000000000L + (to->tv_nsec - from->tv_nsec);
+}
+
+static void add_ns(struct timespec *t, int64_t ns)
+{
+  t->tv_sec += ns / 1000000000L;
+  t->tv_nsec += ns % 1000000000L;
+  if (t->tv_nsec >= 1000000000L)
+  {
+    t->tv_sec++;
+    t->tv_nsec -= 1000000000L;
+  }
+}
+
+// Real time, 1x
+void pacer_init(Pacer *p)
+{
+  memset(p, 0, sizeof(*p));
+  p->frame_ns = PACER_FRAME_NS;
+}
+
+// Speed multiplier between 0.5 and 16, PACER_UNLIMITED to never sleep
+void pacer_set_speed(Pacer *p, double speed)
+{
+  if (speed == PACER_UNLIMITED)
+  {
+    p->frame_ns = 0;
+    return;
+  }
+  if (speed < PACER_MIN_SPEED)
+    speed = PACER_MIN_SPEED;
+  if (speed > PACER_MAX_SPEED)
+    speed = PACER_MAX_SPEED;
+
+  p->frame_ns = PACER_FRAME_NS / speed;
+  p->started = 0;
+}
+
+// Called at VBLANK, blocks until the frame is due
+void pacer_frame(Pacer *p, uint64_t cycles)
+{
+  p->frame_cycles = cycles;
+  if (!p->frame_ns)
+    return;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (!p->started)
+  {
+    p->frame_start = now;
+    p->started = 1;
+    return;
+  }
+
+  struct timespec deadline = p->frame_start;
+  add_ns(&deadline, p->frame_ns);
+
+  // More than a frame behind (debugger, host suspended): start over from
+  // now rather than running flat out to catch up.
+  if (elapsed_ns(&deadline, &now) > p->frame_ns)
+  {
+    p->frame_start = now;
+    p->dropped++;
+    return;
+  }
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+    continue;
+
+  struct timespec before = now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  p->slept_ns += elapsed_ns(&before, &now);
+  int64_t jitter = elapsed_ns(&deadline, &now);
+  p->frames++;
+  p->jitter_total += jitter;
+  if (jitter > p->jitter_max)
+    p->jitter_max = jitter;
+  p->frame_start = deadline;
+}
+
+// How far the emulation at `cycles` is ahead of the wall clock, in ns
+int64_t pacer_ahead_ns(const Pacer *p, uint64_t cycles)
+{
+  if (!p->frame_ns || !p->started)
+    return 0;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  int64_t target = (cycles - p->frame_cycles) * p->frame_ns / FRAME_CYCLES;
+  return target - elapsed_ns(&p->frame_start, &now);
+}
+
+void pacer_report(const Pacer *p, FILE *out)
+{
+  if (!p->frame_ns)
+  {
+    fprintf(out, "pacing: unlimited\n");
+    return;
+  }
+
+  fprintf(out, "pacing: %.2f fps target, %lu frames, jitter mean %.1f us max %.1f us, %lu late frames\n",
+          1e9 / p->frame_ns, (unsigned long)p->frames,
+          p->frames ? p->jitter_total / 1e3 / p->frames : 0.0,
+          p->jitter_max / 1e3, (unsigned long)p->dropped);
+}
@@ -0,0 +1,148 @@
+#include "pixel.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+# define PIXEL_X86
+#endif
+
+uint32_t pixel_argb(uint8_t alpha, uint8_t red, uint8_t green, uint8_t blue)
+{
+  return (uint32_t)alpha << 24 | (uint32_t)red << 16 | (uint32_t)green << 8 | blue;
+}
+
+static void expand_scalar(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out)
+{
+  for (int x = 0; x < 8; x++)
+  {
+    int bit = 7 - x;
+    int colour = ((lo >> bit) & 1) | (((hi >> bit) & 1) << 1);
+    memcpy(out + x * 4, &lut[colour], 4);
+  }
+}
+
+static void expand_masked_scalar(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out)
+{
+  for (int x = 0; x < 8; x++)
+  {
+    int bit = 7 - x;
+    int colour = ((lo >> bit) & 1) | (((hi >> bit) & 1) << 1);
+    if (lut[colour])
+      memcpy(out + x * 4, &lut[colour], 4);
+  }
+}
+
+// The SIMD kernels give each pixel a 32 bit lane holding both plane bytes.
+// Comparing the lane against its own bit gives all ones where the bit is
+// set, which then picks between the LUT entries with and/xor:
+// colour 0 or 1 on `lo`, then that or colour 2 or 3 on `hi`.
+#ifdef __SSE2__
+static __m128i lookup_sse2(__m128i lo, __m128i hi, __m128i bits, const __m128i lut[4])
+{
+  __m128i mlo = _mm_cmpeq_epi32(_mm_and_si128(lo, bits), bits);
+  __m128i mhi = _mm_cmpeq_epi32(_mm_and_si128(hi, bits), bits);
+  __m128i low = _mm_xor_si128(lut[0], _mm_and_si128(mlo, _mm_xor_si128(lut[0], lut[1])));
+  __m128i high = _mm_xor_si128(lut[2], _mm_and_si128(mlo, _mm_xor_si128(lut[2], lut[3])));
+  return _mm_xor_si128(low, _mm_and_si128(mhi, _mm_xor_si128(low, high)));
+}
+
+static void lookup_row_sse2(uint8_t lo, uint8_t hi, const uint32_t lut[4], __m128i row[2])
+{
+  const __m128i l[4] = {
+    _mm_set1_epi32(lut[0]), _mm_set1_epi32(lut[1]),
+    _mm_set1_epi32(lut[2]), _mm_set1_epi32(lut[3])
+  };
+  __m128i vlo = _mm_set1_epi32(lo);
+  __m128i vhi = _mm_set1_epi32(hi);
+  row[0] = lookup_sse2(vlo, vhi, _mm_setr_epi32(0x80, 0x40, 0x20, 0x10), l);
+  row[1] = lookup_sse2(vlo, vhi, _mm_setr_epi32(0x08, 0x04, 0x02, 0x01), l);
+}
+
+static void expand_sse2(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out)
+{
+  __m128i row[2];
+  lookup_row_sse2(lo, hi, lut, row);
+  _mm_storeu_si128((__m128i *)out, row[0]);
+  _mm_storeu_si128((__m128i *)(out + 16), row[1]);
+}
+
+static void expand_masked_sse2(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out)
+{
+  __m128i row[2];
+  lookup_row_sse2(lo, hi, lut, row);
+  for (int i = 0; i < 2; i++)
+  {
+    __m128i *p = (__m128i *)(out + i * 16);
+    __m128i keep = _mm_cmpeq_epi32(row[i], _mm_setzero_si128());
+    __m128i old = _mm_loadu_si128(p);
+    _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(keep, old), row[i]));
+  }
+}
+#endif
+
+#ifdef PIXEL_X86
+__attribute__((target("avx2")))
+static __m256i lookup_avx2(uint8_t lo, uint8_t hi, const uint32_t lut[4])
+{
+  const __m256i bits = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+  __m256i mlo = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(lo), bits), bits);
+  __m256i mhi = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(hi), bits), bits);
+  __m256i low = _mm256_blendv_epi8(_mm256_set1_epi32(lut[0]), _mm256_set1_epi32(lut[1]), mlo);
+  __m256i high = _mm256_blendv_epi8(_mm256_set1_epi32(lut[2]), _mm256_set1_epi32(lut[3]), mlo);
+  return _mm256_blendv_epi8(low, high, mhi);
+}
+
+__attribute__((target("avx2")))
+static void expand_avx2(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out)
+{
+  _mm256_storeu_si256((__m256i *)out, lookup_avx2(lo, hi, lut));
+}
+
+__attribute__((target("avx2")))
+static void expand_masked_avx2(uint8_t lo, uint8_t hi, const uint32_t lut[4], uint8_t *out)
+{
+  __m256i row = lookup_avx2(lo, hi, lut);
+  __m256i keep = _mm256_cmpeq_epi32(row, _mm256_setzero_si256());
+  __m256i old = _mm256_loadu_si256((__m256i *)out);
+  _mm256_storeu_si256((__m256i *)out, _mm256_blendv_epi8(row, old, keep));
+}
+#endif
+
+const Pixel_kernel pixel_kernels[] = {
+  { "scalar", expand_scalar, expand_masked_scalar },
+#ifdef __SSE2__
+  { "sse2", expand_sse2, expand_masked_sse2 },
+#endif
+#ifdef PIXEL_X86
+  { "avx2", expand_avx2, expand_masked_avx2 },
+#endif
+  { NULL, NULL, NULL }
+};
+
+int pixel_kernel_supported(const Pixel_kernel *kernel)
+{
+#ifdef PIXEL_X86
+  if (kernel->expand == expand_avx2)
+  {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+  }
+#endif
+  return kernel->expand != NULL;
+}
+
+const Pixel_kernel *pixel_kernel(void)
+{
+  static const Pixel_kernel *best = NULL;
+
+  const Pixel_kernel *kernel = __atomic_load_n(&best, __ATOMIC_RELAXED);
+  if (kernel)
+    return kernel;
+
+  kernel = &pixel_kernels[0];
+  for (const Pixel_kernel *k = pixel_kernels; k->name; k++)
+    if (pixel_kernel_supported(k))
+      kernel = k;
+  __atomic_store_n(&best, kernel, __ATOMIC_RELAXED);
+  return kernel;
+}
@@ -0,0 +1,118 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include "pool.h"
+
+// Work-stealing pool. Each worker starts with a contiguous block of the
+// tasks, runs it from the end and, once it is empty, takes tasks from the
+// start of another worker's block. No task is added while running, so a
+// worker that finds every block empty is done.
+
+typedef struct Deque
+{
+  pthread_mutex_t lock;
+  int head;                 // next task to steal
+  int tail;                 // one past the next task to run
+} Deque;
+
+typedef struct Pool
+{
+  Deque *deques;
+  int threads;
+  Pool_task task;
+  void *arg;
+} Pool;
+
+typedef struct Worker
+{
+  Pool *pool;
+  int id;
+  int failed;               // tasks of this worker that failed
+} Worker;
+
+static int pop(Deque *d, int *index)
+{
+  int found = 0;
+  pthread_mutex_lock(&d->lock);
+  if (d->head < d->tail)
+  {
+    *index = --d->tail;
+    found = 1;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return found;
+}
+
+static int steal(Deque *d, int *index)
+{
+  int found = 0;
+  pthread_mutex_lock(&d->lock);
+  if (d->head < d->tail)
+  {
+    *index = d->head++;
+    found = 1;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return found;
+}
+
+static void *worker_main(void *arg)
+{
+  Worker *w = arg;
+  Pool *pool = w->pool;
+  int index;
+
+  while (1)
+  {
+    if (pop(&pool->deques[w->id], &index))
+    {
+      w->failed += pool->task(pool->arg, index) != 0;
+      continue;
+    }
+
+    int stolen = 0;
+    for (int i = 1; i < pool->threads && !stolen; i++)
+      stolen = steal(&pool->deques[(w->id + i) % pool->threads], &index);
+    if (!stolen)
+      return NULL;
+    w->failed += pool->task(pool->arg, index) != 0;
+  }
+}
+
+int pool_run(int threads, int count, Pool_task task, void *arg)
+{
+  if (threads < 1)
+    threads = 1;
+  if (threads > count)
+    threads = count > 0 ? count : 1;
+
+  Pool pool = { calloc(threads, sizeof(Deque)), threads, task, arg };
+  Worker *workers = calloc(threads, sizeof(Worker));
+  pthread_t *ids = calloc(threads, sizeof(pthread_t));
+
+  for (int i = 0; i < threads; i++)
+  {
+    pthread_mutex_init(&pool.deques[i].lock, NULL);
+    pool.deques[i].head = (long)count * i / threads;
+    pool.deques[i].tail = (long)count * (i + 1) / threads;
+    workers[i].pool = &pool;
+    workers[i].id = i;
+  }
+
+  // The calling thread is worker 0
+  for (int i = 1; i < threads; i++)
+    pthread_create(&ids[i], NULL, worker_main, &workers[i]);
+  worker_main(&workers[0]);
+  for (int i = 1; i < threads; i++)
+    pthread_join(ids[i], NULL);
+
+  int failed = 0;
+  for (int i = 0; i < threads; i++)
+  {
+    pthread_mutex_destroy(&pool.deques[i].lock);
+    failed += workers[i].failed;
+  }
+  free(ids);
+  free(workers);
+  free(pool.deques);
+  return failed;
+}
@@ -1,342 +1,344 @@
 #include "registers.h"
-
-void init_registers()
-{
-  r.AF.val = 0;
-  r.BC.val = 0;
-  r.DE.val = 0;
-  r.HL.val = 0;
-  r.SP.val = 0;
-  r.PC.val = 0;
-  r.ime = 0;
-  r.joypad = 0xFF;
-  my_clock.total_m = 0;
-  my_clock.total_t = 0;
-  my_clock.lineticks = 0;
-  my_clock.mode = 2;
-  my_clock.divider = 0;
-  my_clock.timer_counter = 0;
-  my_clock.clock_speed = 1024;
-}
-
-void print_r()
+#include "utils.h"
+
+void init_registers(GbContext *gb)
+{
+  gb->r.AF.val = 0;
+  gb->r.BC.val = 0;
+  gb->r.DE.val = 0;
+  gb->r.HL.val = 0;
+  gb->r.SP.val = 0;
+  gb->r.PC.val = 0;
+  gb->r.ime = 0;
+  gb->r.joypad = 0xFF;
+  gb->clock.cycles = 0;
+  gb->clock.mode = 2;
+  gb->clock.mode_start = 0;
+  gb->clock.div_start = 0;
+  gb->clock.timer_start = 0;
+  gb->clock.timer_counter = 0;
+  gb->clock.clock_speed = 1024;
+  init_events(gb);
+}
+
+void print_r(GbContext *gb)
 {
     printf("---Registers---\n");
-    printf("A: %x | F: %x\n", r.AF.bytes.high, r.AF.bytes.low);
-    printf("B: %x | C: %x\n", r.BC.bytes.high, r.BC.bytes.low);
-    printf("D: %x | E: %x\n", r.DE.bytes.high, r.DE.bytes.low);
-    printf("H: %x | L: %x\n", r.HL.bytes.high, r.HL.bytes.low);
-    printf("SP: %x\n", r.SP.val);
-    printf("PC: %x\n", r.PC.val);
-    printf("PAD: %x\n", r.joypad);
-    printf("IME: %x\n", r.ime);
+    printf("A: %x | F: %x\n", gb->r.AF.bytes.high, gb->r.AF.bytes.low);
+    printf("B: %x | C: %x\n", gb->r.BC.bytes.high, gb->r.BC.bytes.low);
+    printf("D: %x | E: %x\n", gb->r.DE.bytes.high, gb->r.DE.bytes.low);
+    printf("H: %x | L: %x\n", gb->r.HL.bytes.high, gb->r.HL.bytes.low);
+    printf("SP: %x\n", gb->r.SP.val);
+    printf("PC: %x\n", gb->r.PC.val);
+    printf("PAD: %x\n", gb->r.joypad);
+    printf("IME: %x\n", gb->r.ime);
     printf("---------------\n");
 }
 
-void setZ(void)
+void setZ(GbContext *gb)
 {
-  r.AF.bytes.low |= 0b10000000;
+  gb->r.AF.bytes.low |= 0b10000000;
 }
 
-void resetZ(void)
+void resetZ(GbContext *gb)
 {
-  r.AF.bytes.low &= 0b01111111;
+  gb->r.AF.bytes.low &= 0b01111111;
 }
 
-void setN(void)
+void setN(GbContext *gb)
 {
-  r.AF.bytes.low |= 0b01000000;
+  gb->r.AF.bytes.low |= 0b01000000;
 }
 
-void resetN(void)
+void resetN(GbContext *gb)
 {
-  r.AF.bytes.low &= 0b10111111;
+  gb->r.AF.bytes.low &= 0b10111111;
 }
 
-void setH(void)
+void setH(GbContext *gb)
 {
-  r.AF.bytes.low |= 0b00100000;
+  gb->r.AF.bytes.low |= 0b00100000;
 }
 
-void resetH(void)
+void resetH(GbContext *gb)
 {
-  r.AF.bytes.low &= 0b11011111;
+  gb->r.AF.bytes.low &= 0b11011111;
 }
 
-void setC(void)
+void setC(GbContext *gb)
 {
-  r.AF.bytes.low |= 0b00010000;
+  gb->r.AF.bytes.low |= 0b00010000;
 }
 
-void resetC(void)
+void resetC(GbContext *gb)
 {
-  r.AF.bytes.low &= 0b11101111;
+  gb->r.AF.bytes.low &= 0b11101111;
 }
 
 // Get Z flag
-uint8_t getZ(void)
+uint8_t getZ(GbContext *gb)
 {
-  return (r.AF.bytes.low & 0b10000000) >> 7;
+  return (gb->r.AF.bytes.low & 0b10000000) >> 7;
 }
 
-uint8_t getN(void)
+uint8_t getN(GbContext *gb)
 {
-  return (r.AF.bytes.low & 0b01000000) >> 6;
+  return (gb->r.AF.bytes.low & 0b01000000) >> 6;
 }
 
-uint8_t getH(void)
+uint8_t getH(GbContext *gb)
 {
-  return (r.AF.bytes.low & 0b00100000) >> 5;
+  return (gb->r.AF.bytes.low & 0b00100000) >> 5;
 }
 
-uint8_t getC(void)
+uint8_t getC(GbContext *gb)
 {
-  return (r.AF.bytes.low & 0b00010000) >> 4;
+  return (gb->r.AF.bytes.low & 0b00010000) >> 4;
 }
 
-void loadba()
+void loadba(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.AF.bytes.high);
+  load(gb, &gb->r.BC.bytes.high, gb->r.AF.bytes.high);
 }
 
-void loadbb()
+void loadbb(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.BC.bytes.high);
+  load(gb, &gb->r.BC.bytes.high, gb->r.BC.bytes.high);
 }
 
-void loadbc()
+void loadbc(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.BC.bytes.low);
+  load(gb, &gb->r.BC.bytes.high, gb->r.BC.bytes.low);
 }
 
-void loadbd()
+void loadbd(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.DE.bytes.high);
+  load(gb, &gb->r.BC.bytes.high, gb->r.DE.bytes.high);
 }
 
-void loadbe()
+void loadbe(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.DE.bytes.low);
+  load(gb, &gb->r.BC.bytes.high, gb->r.DE.bytes.low);
 }
 
-void loadbh()
+void loadbh(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.HL.bytes.high);
+  load(gb, &gb->r.BC.bytes.high, gb->r.HL.bytes.high);
 }
 
-void loadbl()
+void loadbl(GbContext *gb)
 {
-  load(&r.BC.bytes.high, r.HL.bytes.low);
+  load(gb, &gb->r.BC.bytes.high, gb->r.HL.bytes.low);
 }
 
-void loadca()
+void loadca(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.AF.bytes.high);
+  load(gb, &gb->r.BC.bytes.low, gb->r.AF.bytes.high);
 }
 
-void loadcb()
+void loadcb(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.BC.bytes.high);
+  load(gb, &gb->r.BC.bytes.low, gb->r.BC.bytes.high);
 }
 
-void loadcc()
+void loadcc(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.BC.bytes.low);
+  load(gb, &gb->r.BC.bytes.low, gb->r.BC.bytes.low);
 }
 
-void loadcd()
+void loadcd(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.DE.bytes.high);
+  load(gb, &gb->r.BC.bytes.low, gb->r.DE.bytes.high);
 }
 
-void loadce()
+void loadce(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.DE.bytes.low);
+  load(gb, &gb->r.BC.bytes.low, gb->r.DE.bytes.low);
 }
 
-void loadch()
+void loadch(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.HL.bytes.high);
+  load(gb, &gb->r.BC.bytes.low, gb->r.HL.bytes.high);
 }
 
-void loadcl()
+void loadcl(GbContext *gb)
 {
-  load(&r.BC.bytes.low, r.HL.bytes.low);
+  load(gb, &gb->r.BC.bytes.low, gb->r.HL.bytes.low);
 }
 
-void loadda()
+void loadda(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.AF.bytes.high);
+  load(gb, &gb->r.DE.bytes.high, gb->r.AF.bytes.high);
 }
 
-void loaddb()
+void loaddb(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.BC.bytes.high);
+  load(gb, &gb->r.DE.bytes.high, gb->r.BC.bytes.high);
 }
 
-void loaddc()
+void loaddc(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.BC.bytes.low);
+  load(gb, &gb->r.DE.bytes.high, gb->r.BC.bytes.low);
 }
 
-void loaddd()
+void loaddd(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.DE.bytes.high);
+  load(gb, &gb->r.DE.bytes.high, gb->r.DE.bytes.high);
 }
 
-void loadde()
+void loadde(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.DE.bytes.low);
+  load(gb, &gb->r.DE.bytes.high, gb->r.DE.bytes.low);
 }
 
-void loaddh()
+void loaddh(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.HL.bytes.high);
+  load(gb, &gb->r.DE.bytes.high, gb->r.HL.bytes.high);
 }
 
-void loaddl()
+void loaddl(GbContext *gb)
 {
-  load(&r.DE.bytes.high, r.HL.bytes.low);
+  load(gb, &gb->r.DE.bytes.high, gb->r.HL.bytes.low);
 }
 
-void loadea()
+void loadea(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.AF.bytes.high);
+  load(gb, &gb->r.DE.bytes.low, gb->r.AF.bytes.high);
 }
 
-void loadeb()
+void loadeb(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.BC.bytes.high);
+  load(gb, &gb->r.DE.bytes.low, gb->r.BC.bytes.high);
 }
 
-void loadec()
+void loadec(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.BC.bytes.low);
+  load(gb, &gb->r.DE.bytes.low, gb->r.BC.bytes.low);
 }
 
-void loaded()
+void loaded(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.DE.bytes.high);
+  load(gb, &gb->r.DE.bytes.low, gb->r.DE.bytes.high);
 }
 
-void loadee()
+void loadee(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.DE.bytes.low);
+  load(gb, &gb->r.DE.bytes.low, gb->r.DE.bytes.low);
 }
 
-void loadeh()
+void loadeh(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.HL.bytes.high);
+  load(gb, &gb->r.DE.bytes.low, gb->r.HL.bytes.high);
 }
 
-void loadel()
+void loadel(GbContext *gb)
 {
-  load(&r.DE.bytes.low, r.HL.bytes.low);
+  load(gb, &gb->r.DE.bytes.low, gb->r.HL.bytes.low);
 }
 
-void loadha()
+void loadha(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.AF.bytes.high);
+  load(gb, &gb->r.HL.bytes.high, gb->r.AF.bytes.high);
 }
 
-void loadhb()
+void loadhb(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.BC.bytes.high);
+  load(gb, &gb->r.HL.bytes.high, gb->r.BC.bytes.high);
 }
 
-void loadhc()
+void loadhc(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.BC.bytes.low);
+  load(gb, &gb->r.HL.bytes.high, gb->r.BC.bytes.low);
 }
 
-void loadhd()
+void loadhd(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.DE.bytes.high);
+  load(gb, &gb->r.HL.bytes.high, gb->r.DE.bytes.high);
 }
 
-void loadhe()
+void loadhe(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.DE.bytes.low);
+  load(gb, &gb->r.HL.bytes.high, gb->r.DE.bytes.low);
 }
 
-void loadhh()
+void loadhh(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.HL.bytes.high);
+  load(gb, &gb->r.HL.bytes.high, gb->r.HL.bytes.high);
 }
 
-void loadhl()
+void loadhl(GbContext *gb)
 {
-  load(&r.HL.bytes.high, r.HL.bytes.low);
+  load(gb, &gb->r.HL.bytes.high, gb->r.HL.bytes.low);
 }
 
-void loadla()
+void loadla(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.AF.bytes.high);
+  load(gb, &gb->r.HL.bytes.low, gb->r.AF.bytes.high);
 }
 
-void loadlb()
+void loadlb(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.BC.bytes.high);
+  load(gb, &gb->r.HL.bytes.low, gb->r.BC.bytes.high);
 }
 
-void loadlc()
+void loadlc(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.BC.bytes.low);
+  load(gb, &gb->r.HL.bytes.low, gb->r.BC.bytes.low);
 }
 
-void loadld()
+void loadld(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.DE.bytes.high);
+  load(gb, &gb->r.HL.bytes.low, gb->r.DE.bytes.high);
 }
 
-void loadle()
+void loadle(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.DE.bytes.low);
+  load(gb, &gb->r.HL.bytes.low, gb->r.DE.bytes.low);
 }
 
-void loadlh()
+void loadlh(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.HL.bytes.high);
+  load(gb, &gb->r.HL.bytes.low, gb->r.HL.bytes.high);
 }
 
-void loadll()
+void loadll(GbContext *gb)
 {
-  load(&r.HL.bytes.low, r.HL.bytes.low);
+  load(gb, &gb->r.HL.bytes.low, gb->r.HL.bytes.low);
 }
 
-void loadaa()
+void loadaa(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.AF.bytes.high);
+  load(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high);
 }
 
-void loadab()
+void loadab(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.BC.bytes.high);
+  load(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high);
 }
 
-void loadac()
+void loadac(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.BC.bytes.low);
+  load(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low);
 }
 
-void loadad()
+void loadad(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.DE.bytes.high);
+  load(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high);
 }
 
-void loadae()
+void loadae(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.DE.bytes.low);
+  load(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low);
 }
 
-void loadah()
+void loadah(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.HL.bytes.high);
+  load(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high);
 }
 
-void loadal()
+void loadal(GbContext *gb)
 {
-  load(&r.AF.bytes.high, r.HL.bytes.low);
+  load(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low);
 }
 
 // Test if but = 1 with index: 7 6 5 4 3 2 1 0
@@ -0,0 +1,262 @@
+#include <string.h>
+#include "rewind.h"
+#include "state.h"
+
+// Zero runs shorter than this are kept in the literals, a run costs a few
+// bytes of lengths
+#define MIN_RUN 4
+
+static uint8_t *put_varint(uint8_t *p, size_t v)
+{
+  while (v >= 0x80)
+  {
+    *p++ = (v & 0x7F) | 0x80;
+    v >>= 7;
+  }
+  *p++ = v;
+  return p;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, size_t *v)
+{
+  int shift = 0;
+  *v = 0;
+  do
+  {
+    *v |= (size_t)(*p & 0x7F) << shift;
+    shift += 7;
+  } while (*p++ & 0x80);
+  return p;
+}
+
+// Encode `src` XOR `ref` (just `src` when ref is NULL) as pairs of a zero
+// run length and a literal run. Returns the bytes written to `dst`.
+static size_t encode(uint8_t *dst, const uint8_t *src, const uint8_t *ref, size_t len)
+{
+  uint8_t *p = dst;
+  size_t i = 0;
+
+  while (i < len)
+  {
+    size_t zeros = i;
+    while (zeros < len && src[zeros] == (ref ? ref[zeros] : 0))
+      zeros++;
+
+    // Literals up to the next zero run long enough to be worth a pair
+    size_t end = zeros;
+    size_t run = 0;
+    while (end < len && run < MIN_RUN)
+    {
+      run = src[end] == (ref ? ref[end] : 0) ? run + 1 : 0;
+      end++;
+    }
+    if (run == MIN_RUN)
+      end -= MIN_RUN;
+
+    p = put_varint(p, zeros - i);
+    p = put_varint(p, end - zeros);
+    for (size_t j = zeros; j < end; j++)
+      *p++ = src[j] ^ (ref ? ref[j] : 0);
+    i = end;
+  }
+  return p - dst;
+}
+
+static void decode(uint8_t *dst, const uint8_t *src, size_t src_len, const uint8_t *ref, size_t len)
+{
+  const uint8_t *end = src + src_len;
+  size_t i = 0;
+
+  if (ref)
+    memcpy(dst, ref, len);
+  else
+    memset(dst, 0, len);
+
+  while (src < end)
+  {
+    size_t zeros;
+    size_t literals;
+    src = get_varint(src, &zeros);
+    src = get_varint(src, &literals);
+    i += zeros;
+    for (size_t j = 0; j < literals; j++)
+      dst[i++] ^= *src++;
+  }
+}
+
+static RewindEntry *entry(Rewind *rw, uint64_t frame)
+{
+  return &rw->entries[(rw->first + (frame - rw->first_frame)) % rw->max_entries];
+}
+
+static RewindEntry *oldest(Rewind *rw)
+{
+  return &rw->entries[rw->first];
+}
+
+static void drop_oldest(Rewind *rw)
+{
+  rw->first = (rw->first + 1) % rw->max_entries;
+  rw->first_frame++;
+  rw->count--;
+
+  // States of a dropped keyframe can't be decoded anymore
+  while (rw->count && oldest(rw)->key != rw->first_frame)
+  {
+    rw->first = (rw->first + 1) % rw->max_entries;
+    rw->first_frame++;
+    rw->count--;
+  }
+  if (!rw->count)
+    rw->head = 0;
+}
+
+// Free `len` contiguous bytes in the data ring, dropping the oldest
+// entries as needed. Entries never wrap, the end of the ring is skipped.
+static size_t make_room(Rewind *rw, size_t len)
+{
+  while (rw->count)
+  {
+    size_t old = oldest(rw)->offset;
+    if (old >= rw->head)
+    {
+      // Wrapped, the free space is between head and the oldest entry
+      if (rw->head + len <= old)
+        break;
+      drop_oldest(rw);
+    }
+    else if (rw->head + len <= rw->capacity)
+      break;
+    else
+      rw->head = 0;
+  }
+  size_t offset = rw->head;
+  rw->head += len;
+  return offset;
+}
+
+Rewind *rewind_new(const GbContext *gb, uint32_t frames, size_t bytes)
+{
+  Rewind *rw = calloc(1, sizeof(Rewind));
+  if (!rw)
+    return NULL;
+
+  rw->capacity = bytes;
+  rw->max_entries = frames ? frames : 1;
+  rw->state_len = state_size(gb);
+  rw->base_key = UINT64_MAX;
+  rw->data = malloc(bytes);
+  rw->entries = calloc(rw->max_entries, sizeof(RewindEntry));
+  rw->state = malloc(rw->state_len);
+  rw->base = malloc(rw->state_len);
+  // Worst case of the encoding: two lengths per MIN_RUN bytes of literals
+  rw->encoded = malloc(rw->state_len * 2 + 16);
+  if (!rw->data || !rw->entries || !rw->state || !rw->base || !rw->encoded)
+  {
+    rewind_free(rw);
+    return NULL;
+  }
+  return rw;
+}
+
+void rewind_free(Rewind *rw)
+{
+  if (!rw)
+    return;
+  free(rw->data);
+  free(rw->entries);
+  free(rw->state);
+  free(rw->base);
+  free(rw->encoded);
+  free(rw);
+}
+
+// Decode the keyframe `key` into base unless it is already there
+static void load_base(Rewind *rw, uint64_t key)
+{
+  if (rw->base_key == key)
+    return;
+  RewindEntry *e = entry(rw, key);
+  decode(rw->base, rw->data + e->offset, e->len, NULL, rw->state_len);
+  rw->base_key = key;
+}
+
+// Encode the saved state as a keyframe of its own
+static size_t encode_key(Rewind *rw, uint64_t frame)
+{
+  memcpy(rw->base, rw->state, rw->state_len);
+  rw->base_key = frame;
+  return encode(rw->encoded, rw->state, NULL, rw->state_len);
+}
+
+void rewind_push(Rewind *rw, const GbContext *gb)
+{
+  if (rw->count == rw->max_entries)
+    drop_oldest(rw);
+
+  uint64_t frame = rw->first_frame + rw->count;
+  uint64_t key = frame;
+  size_t len;
+
+  state_save(gb, rw->state);
+  if (rw->count && frame - entry(rw, frame - 1)->key < REWIND_KEYFRAME_INTERVAL)
+  {
+    key = entry(rw, frame - 1)->key;
+    load_base(rw, key);
+    len = encode(rw->encoded, rw->state, rw->base, rw->state_len);
+  }
+  else
+    len = encode_key(rw, frame);
+  if (len > rw->capacity)
+    return;
+
+  size_t offset = make_room(rw, len);
+  if (key != frame && !rw->count)
+  {
+    // Its keyframe was dropped to make room, the ring is empty now. The
+    // space kept for the delta is given back, the keyframe is bigger.
+    rw->head = 0;
+    key = frame;
+    len = encode_key(rw, frame);
+    if (len > rw->capacity)
+      return;
+    offset = make_room(rw, len);
+  }
+
+  RewindEntry *e = entry(rw, frame);
+  e->offset = offset;
+  e->len = len;
+  e->key = key;
+  memcpy(rw->data + offset, rw->encoded, len);
+  rw->count++;
+}
+
+int rewind_pop(Rewind *rw, GbContext *gb)
+{
+  if (!rw->count)
+    return -1;
+
+  uint64_t frame = rw->first_frame + rw->count - 1;
+  RewindEntry *e = entry(rw, frame);
+  if (e->key == frame)
+    decode(rw->state, rw->data + e->offset, e->len, NULL, rw->state_len);
+  else
+  {
+    load_base(rw, e->key);
+    decode(rw->state, rw->data + e->offset, e->len, rw->base, rw->state_len);
+  }
+
+  rw->count--;
+  rw->head = rw->count ? e->offset : 0;
+  if (e->key == frame)
+    rw->base_key = UINT64_MAX;
+  return state_load(gb, rw->state, rw->state_len);
+}
+
+size_t rewind_used(const Rewind *rw)
+{
+  size_t used = 0;
+  for (uint32_t i = 0; i < rw->count; i++)
+    used += rw->entries[(rw->first + i) % rw->max_entries].len;
+  return used;
+}
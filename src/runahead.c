@@ -0,0 +1,102 @@
+#include <string.h>
+#include "runahead.h"
+#include "state.h"
+#include "gb.h"
+
+static int64_t now_ns(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000L + t.tv_nsec;
+}
+
+// Moving average over about 16 frames, so one slow frame does not change N
+static int64_t average(int64_t avg, int64_t sample)
+{
+  return avg ? avg + (sample - avg) / 16 : sample;
+}
+
+static int64_t frame_period(const Pacer *p)
+{
+  return p->frame_ns ? p->frame_ns : PACER_FRAME_NS;
+}
+
+Runahead *runahead_new(const GbContext *gb, int frames)
+{
+  Runahead *ra = calloc(1, sizeof(Runahead));
+  if (!ra)
+    return NULL;
+
+  ra->frames = frames;
+  ra->current = frames == RUNAHEAD_AUTO ? 0 : frames;
+  ra->state_len = state_size(gb);
+  ra->state = malloc(ra->state_len);
+  if (!ra->state)
+  {
+    free(ra);
+    return NULL;
+  }
+  return ra;
+}
+
+void runahead_free(Runahead *ra)
+{
+  if (!ra)
+    return;
+  free(ra->state);
+  free(ra);
+}
+
+uint32_t runahead_frame(Runahead *ra, GbContext *gb)
+{
+  int64_t start = now_ns();
+  int64_t slept = gb->pacer.slept_ns;
+
+  uint32_t cycles = gb_run_frame(gb);
+  int64_t copy = 0;
+
+  if (ra->current)
+  {
+    int64_t t = now_ns();
+    state_save(gb, ra->state);
+    copy = now_ns() - t;
+
+    // The frames ahead are not shown at their own deadline
+    Pacer pacer = gb->pacer;
+    gb->pacer.frame_ns = 0;
+    for (int i = 0; i < ra->current; i++)
+      gb_run_frame(gb);
+    gb->pacer = pacer;
+
+    t = now_ns();
+    state_load(gb, ra->state, ra->state_len);
+    copy += now_ns() - t;
+    ra->copy_cost_ns = average(ra->copy_cost_ns, copy);
+  }
+
+  int64_t work = now_ns() - start - (gb->pacer.slept_ns - slept);
+  ra->frame_cost_ns = average(ra->frame_cost_ns, (work - copy) / (ra->current + 1));
+  ra->headroom_ns = average(ra->headroom_ns, frame_period(&gb->pacer) - work);
+
+  if (ra->frames == RUNAHEAD_AUTO)
+    ra->current = runahead_fit(ra, &gb->pacer);
+  return cycles;
+}
+
+int runahead_fit(const Runahead *ra, const Pacer *p)
+{
+  if (!ra->frame_cost_ns)
+    return 0;
+
+  int64_t budget = frame_period(p) * 3 / 4 - ra->copy_cost_ns;
+  int64_t frames = budget / ra->frame_cost_ns - 1;
+  if (frames < 0)
+    return 0;
+  return frames > RUNAHEAD_MAX_FRAMES ? RUNAHEAD_MAX_FRAMES : frames;
+}
+
+void runahead_report(const Runahead *ra, FILE *out)
+{
+  fprintf(out, "run-ahead: %d frames, %.1f us per frame, %.1f us per save and load, %.1f us headroom\n",
+          ra->current, ra->frame_cost_ns / 1e3, ra->copy_cost_ns / 1e3, ra->headroom_ns / 1e3);
+}
@@ -0,0 +1,111 @@
+#include "scheduler.h"
+
+#define NOT_QUEUED 0xFF
+
+static void swap(Scheduler *s, uint8_t i, uint8_t j)
+{
+  uint8_t tmp = s->heap[i];
+  s->heap[i] = s->heap[j];
+  s->heap[j] = tmp;
+  s->pos[s->heap[i]] = i;
+  s->pos[s->heap[j]] = j;
+}
+
+static int earlier(Scheduler *s, uint8_t i, uint8_t j)
+{
+  return s->deadline[s->heap[i]] < s->deadline[s->heap[j]];
+}
+
+static void sift_up(Scheduler *s, uint8_t i)
+{
+  while (i > 0 && earlier(s, i, (i - 1) / 2))
+  {
+    swap(s, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+static void sift_down(Scheduler *s, uint8_t i)
+{
+  while (1)
+  {
+    uint8_t min = i;
+    uint8_t left = 2 * i + 1;
+    uint8_t right = 2 * i + 2;
+
+    if (left < s->size && earlier(s, left, min))
+      min = left;
+    if (right < s->size && earlier(s, right, min))
+      min = right;
+    if (min == i)
+      return;
+
+    swap(s, i, min);
+    i = min;
+  }
+}
+
+static void update_next(Scheduler *s)
+{
+  s->next = s->size ? s->deadline[s->heap[0]] : EVENT_NEVER;
+}
+
+void scheduler_init(Scheduler *s)
+{
+  s->size = 0;
+  for (int i = 0; i < EVENT_COUNT; i++)
+  {
+    s->deadline[i] = EVENT_NEVER;
+    s->pos[i] = NOT_QUEUED;
+  }
+  update_next(s);
+}
+
+// Add an event or move it to a new deadline
+void scheduler_schedule(Scheduler *s, EventType ev, uint64_t when)
+{
+  uint64_t old = s->deadline[ev];
+  s->deadline[ev] = when;
+
+  if (s->pos[ev] == NOT_QUEUED)
+  {
+    s->pos[ev] = s->size;
+    s->heap[s->size++] = ev;
+    sift_up(s, s->pos[ev]);
+  }
+  else if (when < old)
+    sift_up(s, s->pos[ev]);
+  else
+    sift_down(s, s->pos[ev]);
+
+  update_next(s);
+}
+
+void scheduler_cancel(Scheduler *s, EventType ev)
+{
+  uint8_t i = s->pos[ev];
+  if (i == NOT_QUEUED)
+    return;
+
+  s->size--;
+  if (i != s->size)
+  {
+    swap(s, i, s->size);
+    sift_down(s, i);
+    sift_up(s, i);
+  }
+  s->pos[ev] = NOT_QUEUED;
+  s->deadline[ev] = EVENT_NEVER;
+  update_next(s);
+}
+
+// Remove and return the earliest event due at `now`, -1 if there is none
+int scheduler_pop(Scheduler *s, uint64_t now)
+{
+  if (s->next > now)
+    return -1;
+
+  int ev = s->heap[0];
+  scheduler_cancel(s, ev);
+  return ev;
+}
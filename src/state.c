@@ -0,0 +1,225 @@
+#include <string.h>
+#include "state.h"
+
+#define STATE_HEADER 16
+
+// Header: magic, version, kind, pad, RAM size and the cartridge checksums
+static void header(const GbContext *gb, uint8_t kind, uint8_t out[STATE_HEADER])
+{
+  memset(out, 0, STATE_HEADER);
+  memcpy(out, "GBST", 4);
+  out[4] = STATE_VERSION;
+  out[5] = kind;
+  memcpy(&out[8], &gb->mmu.ram_size, 4);
+  out[12] = gb->mmu.game[0x14D];
+  out[13] = gb->mmu.game[0x14E];
+  out[14] = gb->mmu.game[0x14F];
+}
+
+#define PUT(p, field) do { memcpy(p, &(field), sizeof(field)); p += sizeof(field); } while (0)
+#define GET(p, field) do { memcpy(&(field), p, sizeof(field)); p += sizeof(field); } while (0)
+
+// Every field, in order, through the same list for saving and loading
+#define STATE_FIELDS(OP, p, gb) \
+  OP(p, gb->r.AF.val); OP(p, gb->r.BC.val); OP(p, gb->r.DE.val); \
+  OP(p, gb->r.HL.val); OP(p, gb->r.SP.val); OP(p, gb->r.PC.val); \
+  OP(p, gb->r.ime); OP(p, gb->r.joypad); \
+  OP(p, gb->clock.m); OP(p, gb->clock.t); OP(p, gb->clock.cycles); \
+  OP(p, gb->clock.mode); OP(p, gb->clock.mode_start); OP(p, gb->clock.div_start); \
+  OP(p, gb->clock.timer_start); OP(p, gb->clock.timer_counter); \
+  OP(p, gb->clock.clock_speed); \
+  OP(p, gb->mmu.CUR_ROM); OP(p, gb->mmu.CUR_RAM); OP(p, gb->mmu.ENABLE_RAM); \
+  OP(p, gb->mmu.ROM_BANKING); OP(p, gb->mmu.HALT); OP(p, gb->mmu.MEMORY_MODEL); \
+  OP(p, gb->mmu.BIOS_MODE); \
+  OP(p, gb->scheduler.deadline)
+
+// Bytes of the fields both kinds of state start with
+static size_t fields_size(const GbContext *gb)
+{
+  size_t size = 0;
+  #define SIZE(size, field) size += sizeof(field)
+  STATE_FIELDS(SIZE, size, gb);
+  #undef SIZE
+  return size;
+}
+
+size_t state_size(const GbContext *gb)
+{
+  return STATE_HEADER + fields_size(gb) + sizeof(gb->mmu.memory) + gb->mmu.ram_size;
+}
+
+size_t state_save(const GbContext *gb, uint8_t *buf)
+{
+  uint8_t *p = buf;
+
+  header(gb, STATE_FULL, p);
+  p += STATE_HEADER;
+  STATE_FIELDS(PUT, p, gb);
+  PUT(p, gb->mmu.memory);
+  if (gb->mmu.ram_size)
+  {
+    memcpy(p, gb->mmu.ram, gb->mmu.ram_size);
+    p += gb->mmu.ram_size;
+  }
+  return p - buf;
+}
+
+// Rebuild what derives from the state: page tables, video caches and the
+// event heap
+static void state_loaded(GbContext *gb)
+{
+  uint64_t deadline[EVENT_COUNT];
+
+  map_pages(gb);
+  video_cache_reset(gb);
+  memcpy(deadline, gb->scheduler.deadline, sizeof(deadline));
+  scheduler_init(&gb->scheduler);
+  for (int ev = 0; ev < EVENT_COUNT; ev++)
+    if (deadline[ev] != EVENT_NEVER)
+      scheduler_schedule(&gb->scheduler, ev, deadline[ev]);
+}
+
+int state_load(GbContext *gb, const uint8_t *buf, size_t len)
+{
+  uint8_t expected[STATE_HEADER];
+  const uint8_t *p = buf;
+
+  header(gb, STATE_FULL, expected);
+  if (len != state_size(gb) || memcmp(buf, expected, STATE_HEADER))
+    return -1;
+  p += STATE_HEADER;
+  STATE_FIELDS(GET, p, gb);
+  GET(p, gb->mmu.memory);
+  if (gb->mmu.ram_size)
+    memcpy(gb->mmu.ram, p, gb->mmu.ram_size);
+
+  // Any page may differ from the one at the last clear
+  memset(gb->mmu.dirty, 1, sizeof(gb->mmu.dirty));
+  state_loaded(gb);
+  return 0;
+}
+
+// Pages a delta can hold, the memory map and every page of the RAM
+static int delta_pages(const GbContext *gb)
+{
+  return 0x100 + gb->mmu.ram_size / 0x100;
+}
+
+void state_clear_dirty(GbContext *gb)
+{
+  memset(gb->mmu.dirty, 0, sizeof(gb->mmu.dirty));
+}
+
+size_t state_delta_max(const GbContext *gb)
+{
+  return state_size(gb) + delta_pages(gb) * sizeof(uint16_t) + sizeof(uint16_t);
+}
+
+size_t state_save_delta(const GbContext *gb, uint8_t *buf)
+{
+  uint8_t *p = buf;
+  uint16_t count = 0;
+
+  header(gb, STATE_DELTA, p);
+  p += STATE_HEADER;
+  STATE_FIELDS(PUT, p, gb);
+
+  uint8_t *count_at = p;
+  p += sizeof(count);
+  for (uint16_t page = 0; page < delta_pages(gb); page++)
+  {
+    // The timers, PPU and interupts update the I/O page without going
+    // through the write paths, it is always kept
+    if (!gb->mmu.dirty[page] && page != 0xFF)
+      continue;
+    PUT(p, page);
+    if (page < 0x100)
+      memcpy(p, &gb->mmu.memory[page << 8], 0x100);
+    else
+      memcpy(p, &gb->mmu.ram[(page - 0x100) << 8], 0x100);
+    p += 0x100;
+    count++;
+  }
+  memcpy(count_at, &count, sizeof(count));
+  return p - buf;
+}
+
+int state_load_delta(GbContext *gb, const uint8_t *buf, size_t len)
+{
+  uint8_t expected[STATE_HEADER];
+  const uint8_t *p = buf;
+  const size_t fixed = STATE_HEADER + fields_size(gb);
+  uint16_t count;
+  uint16_t page;
+
+  header(gb, STATE_DELTA, expected);
+  if (len < fixed + sizeof(count) || memcmp(buf, expected, STATE_HEADER))
+    return -1;
+
+  // Check the whole delta before anything is loaded from it
+  memcpy(&count, buf + fixed, sizeof(count));
+  const uint8_t *pages = buf + fixed + sizeof(count);
+  if (len - fixed - sizeof(count) != count * (sizeof(page) + 0x100))
+    return -1;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    memcpy(&page, pages + i * (sizeof(page) + 0x100), sizeof(page));
+    if (page >= delta_pages(gb))
+      return -1;
+  }
+
+  p += STATE_HEADER;
+  STATE_FIELDS(GET, p, gb);
+  p += sizeof(count);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    GET(p, page);
+    if (page < 0x100)
+      memcpy(&gb->mmu.memory[page << 8], p, 0x100);
+    else
+      memcpy(&gb->mmu.ram[(page - 0x100) << 8], p, 0x100);
+    gb->mmu.dirty[page] = 1;
+    p += 0x100;
+  }
+
+  state_loaded(gb);
+  return 0;
+}
+
+int state_write(const GbContext *gb, const char *path)
+{
+  size_t size = state_size(gb);
+  uint8_t *buf = malloc(size);
+  FILE *file = fopen(path, "wb");
+  int ret = -1;
+
+  if (buf && file)
+  {
+    state_save(gb, buf);
+    ret = fwrite(buf, size, 1, file) == 1 ? 0 : -1;
+  }
+  if (ret)
+    fprintf(stderr, "Error saving state %s\n", path);
+  if (file)
+    fclose(file);
+  free(buf);
+  return ret;
+}
+
+int state_read(GbContext *gb, const char *path)
+{
+  size_t size = state_size(gb);
+  uint8_t *buf = malloc(size + 1);
+  FILE *file = fopen(path, "rb");
+  int ret = -1;
+
+  // One byte more than expected so a longer file is refused too
+  if (buf && file)
+    ret = state_load(gb, buf, fread(buf, 1, size + 1, file));
+  if (ret)
+    fprintf(stderr, "Error loading state %s\n", path);
+  if (file)
+    fclose(file);
+  free(buf);
+  return ret;
+}
@@ -1,27 +1,49 @@
 #include "utils.h"
 
-extern Mmu MMU;
-extern Registers r;
-extern My_clock my_clock;
-extern void (*Opcodes[0x100]) (void);
-extern void (*PrefixCB[0x100]) (void);
+// Allocate a powered off machine with the default host settings
+GbContext *context_new(void)
+{
+  GbContext *gb = calloc(1, sizeof(GbContext));
+  uint8_t *framebuffer = calloc(SCREEN_WIDTH * SCREEN_HEIGHT * 4, 1);
+  uint8_t *shades = calloc(SCREEN_WIDTH * SCREEN_HEIGHT, 1);
+  if (!gb || !framebuffer || !shades)
+  {
+    fprintf(stderr, "Could not allocate the emulator\n");
+    exit(1);
+  }
+  gb->framebuffer = framebuffer;
+  gb->shades = shades;
+  pacer_init(&gb->pacer);
+  return gb;
+}
 
-void init(void)
+void context_free(GbContext *gb)
 {
-    init_registers();
-    load_opcodes();
-    load_prefixcb();
-    init_mmu("misc/bios.bin");
+  free_mmu(gb);
+  free(gb->framebuffer);
+  free(gb->shades);
+  free(gb);
+}
+
+// Power on with the boot ROM at mmu.path_bios, or BIOS_PATH. Returns -1 if
+// it or the cartridge can't be loaded.
+int init(GbContext *gb)
+{
+    init_registers(gb);
+    if (init_mmu(gb, gb->mmu.path_bios ? gb->mmu.path_bios : BIOS_PATH))
+      return -1;
+    check_coincidence(gb);
+    return 0;
 }
 
 // NOP
-void opcode_0x00(void) { my_clock.m = 1; my_clock.t = 4; }
+void opcode_0x00(GbContext *gb) { gb->clock.m = 1; gb->clock.t = 4; }
 
 // STOP
-void opcode_0x10(void)
+void opcode_0x10(GbContext *gb)
 {
   // Test for speed switch
-  if (test_bit(MMU.memory[0xFF4D], 0))
+  if (test_bit(gb->mmu.memory[0xFF4D], 0))
   {
     // TODO: Handle speed switch
   }
@@ -30,1942 +52,2060 @@ void opcode_0x10(void)
     printf("Stop, exit...");
     exit(1);
   }
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // POP OPS
-void opcode_0xc1(void) { pop_op(&r.BC.val); }
-void opcode_0xd1(void) { pop_op(&r.DE.val); }
-void opcode_0xe1(void) { pop_op(&r.HL.val); }
-void opcode_0xf1(void) { pop_op(&r.AF.val); r.AF.val &= 0xFFF0; }
+void opcode_0xc1(GbContext *gb) { pop_op(gb, &gb->r.BC.val); }
+void opcode_0xd1(GbContext *gb) { pop_op(gb, &gb->r.DE.val); }
+void opcode_0xe1(GbContext *gb) { pop_op(gb, &gb->r.HL.val); }
+void opcode_0xf1(GbContext *gb) { pop_op(gb, &gb->r.AF.val); gb->r.AF.val &= 0xFFF0; }
 
 // PUSH OPS
-void opcode_0xc5(void) { push_op(r.BC.val); }
-void opcode_0xd5(void) { push_op(r.DE.val); }
-void opcode_0xe5(void) { push_op(r.HL.val); }
-void opcode_0xf5(void) { push_op(r.AF.val); }
+void opcode_0xc5(GbContext *gb) { push_op(gb, gb->r.BC.val); }
+void opcode_0xd5(GbContext *gb) { push_op(gb, gb->r.DE.val); }
+void opcode_0xe5(GbContext *gb) { push_op(gb, gb->r.HL.val); }
+void opcode_0xf5(GbContext *gb) { push_op(gb, gb->r.AF.val); }
 
 // CALL Z, a16
-void opcode_0xcc(void)
+void opcode_0xcc(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (getZ())
+  uint16_t addr = read_word(gb);
+  if (getZ(gb))
   {
-    push_stack(r.PC.val);
-    r.PC.val = addr;
-    my_clock.t = 24;
+    push_stack(gb, gb->r.PC.val);
+    gb->r.PC.val = addr;
+    gb->clock.t = 24;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // CALL NZ, a16
-void opcode_0xc4(void)
+void opcode_0xc4(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (!getZ())
+  uint16_t addr = read_word(gb);
+  if (!getZ(gb))
   {
-    push_stack(r.PC.val);
-    r.PC.val = addr;
-    my_clock.t = 24;
+    push_stack(gb, gb->r.PC.val);
+    gb->r.PC.val = addr;
+    gb->clock.t = 24;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // CALL C, a16
-void opcode_0xdc(void)
+void opcode_0xdc(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (getC())
+  uint16_t addr = read_word(gb);
+  if (getC(gb))
   {
-    push_stack(r.PC.val);
-    r.PC.val = addr;
-    my_clock.t = 24;
+    push_stack(gb, gb->r.PC.val);
+    gb->r.PC.val = addr;
+    gb->clock.t = 24;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // CALL NC, a16
-void opcode_0xd4(void)
+void opcode_0xd4(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (!getC())
+  uint16_t addr = read_word(gb);
+  if (!getC(gb))
   {
-    push_stack(r.PC.val);
-    r.PC.val = addr;
-    my_clock.t = 24;
+    push_stack(gb, gb->r.PC.val);
+    gb->r.PC.val = addr;
+    gb->clock.t = 24;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // CALL a16
-void opcode_0xcd(void)
+void opcode_0xcd(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  push_stack(r.PC.val);
-  r.PC.val = addr;
-
-  my_clock.m = 3;
-  my_clock.t = 24;
-}
+  uint16_t addr = read_word(gb);
+  push_stack(gb, gb->r.PC.val);
+  gb->r.PC.val = addr;
 
-void prefixcb(void)
-{
-    uint8_t op = read_byte();
-    if (!PrefixCB[op])
-    {
-      fprintf(stderr, "Unknown Prefix Op: 0x%x at 0x%x", op, r.PC.val - 1);
-      exit(1);
-    }
-    PrefixCB[op]();
+  gb->clock.m = 3;
+  gb->clock.t = 24;
 }
 
-void loadhlpa(void)
+void loadhlpa(GbContext *gb)
 {
-  write_memory(r.HL.val, r.AF.bytes.high);
-  r.HL.val++;
+  write_memory(gb, gb->r.HL.val, gb->r.AF.bytes.high);
+  gb->r.HL.val++;
 
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (BC), A
-void opcode_0x02(void)
+void opcode_0x02(GbContext *gb)
 {
-  write_memory(r.BC.val, r.AF.bytes.high);
+  write_memory(gb, gb->r.BC.val, gb->r.AF.bytes.high);
 
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (DE), A
-void opcode_0x12(void)
+void opcode_0x12(GbContext *gb)
 {
-  write_memory(r.DE.val, r.AF.bytes.high);
+  write_memory(gb, gb->r.DE.val, gb->r.AF.bytes.high);
 
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
-void loadhlma(void)
+void loadhlma(GbContext *gb)
 {
-  write_memory(r.HL.val, r.AF.bytes.high);
-  r.HL.val--;
+  write_memory(gb, gb->r.HL.val, gb->r.AF.bytes.high);
+  gb->r.HL.val--;
 
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // JR NZ, r8
-void opcode_0x20(void)
+void opcode_0x20(GbContext *gb)
 {
-  int8_t addr = read_byte();
-  if (!getZ())
+  int8_t addr = read_byte(gb);
+  if (!getZ(gb))
   {
-    r.PC.val += addr;
-    my_clock.t = 12;
+    gb->r.PC.val += addr;
+    gb->clock.t = 12;
   }
   else
   {
-    my_clock.t = 8;
+    gb->clock.t = 8;
   }
 
-  my_clock.m = 2;
+  gb->clock.m = 2;
 }
 
-void loadcd8(void)
+void loadcd8(GbContext *gb)
 {
-  r.BC.bytes.low = read_byte();
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->r.BC.bytes.low = read_byte(gb);
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void loaded8(void)
+void loaded8(GbContext *gb)
 {
-  r.DE.bytes.low = read_byte();
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->r.DE.bytes.low = read_byte(gb);
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void loadld8(void)
+void loadld8(GbContext *gb)
 {
-  r.HL.bytes.low = read_byte();
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->r.HL.bytes.low = read_byte(gb);
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
-void loadad8(void)
+void loadad8(GbContext *gb)
 {
-  r.AF.bytes.high = read_byte();
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->r.AF.bytes.high = read_byte(gb);
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
 // LOAD (C), A
-void opcode_0xe2(void)
+void opcode_0xe2(GbContext *gb)
 {
-  uint16_t pos = 0xFF00 + r.BC.bytes.low;
-  write_memory(pos, r.AF.bytes.high);
+  uint16_t pos = 0xFF00 + gb->r.BC.bytes.low;
+  write_memory(gb, pos, gb->r.AF.bytes.high);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
 // LOAD A, (C)
-void opcode_0xf2(void)
+void opcode_0xf2(GbContext *gb)
 {
-  uint16_t pos = 0xFF00 + r.BC.bytes.low;
-  r.AF.bytes.high = read_memory(pos);
+  uint16_t pos = 0xFF00 + gb->r.BC.bytes.low;
+  gb->r.AF.bytes.high = read_memory(gb, pos);
 
-  my_clock.m = 2;
-  my_clock.t = 8;
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
 // INC OPS
-void opcode_0x0c(void) { inc_op(&r.BC.bytes.low); }
-void opcode_0x1c(void) { inc_op(&r.DE.bytes.low); }
-void opcode_0x2c(void) { inc_op(&r.HL.bytes.low); }
-void opcode_0x3c(void) { inc_op(&r.AF.bytes.high); }
-void opcode_0x04(void) { inc_op(&r.BC.bytes.high); }
-void opcode_0x14(void) { inc_op(&r.DE.bytes.high); }
-void opcode_0x24(void) { inc_op(&r.HL.bytes.high); }
-void opcode_0x34(void)
+void opcode_0x0c(GbContext *gb) { inc_op(gb, &gb->r.BC.bytes.low); }
+void opcode_0x1c(GbContext *gb) { inc_op(gb, &gb->r.DE.bytes.low); }
+void opcode_0x2c(GbContext *gb) { inc_op(gb, &gb->r.HL.bytes.low); }
+void opcode_0x3c(GbContext *gb) { inc_op(gb, &gb->r.AF.bytes.high); }
+void opcode_0x04(GbContext *gb) { inc_op(gb, &gb->r.BC.bytes.high); }
+void opcode_0x14(GbContext *gb) { inc_op(gb, &gb->r.DE.bytes.high); }
+void opcode_0x24(GbContext *gb) { inc_op(gb, &gb->r.HL.bytes.high); }
+void opcode_0x34(GbContext *gb)
 {
-  uint8_t hl = read_memory(r.HL.val);
+  uint8_t hl = read_memory(gb, gb->r.HL.val);
 
-  write_memory(r.HL.val, hl + 1);
-  read_memory(r.HL.val) == 0 ? setZ() : resetZ();
-  ((read_memory(r.HL.val) ^ 0x01 ^ hl) & 0x10) ? setH() : resetH();
-  resetN();
+  write_memory(gb, gb->r.HL.val, hl + 1);
+  read_memory(gb, gb->r.HL.val) == 0 ? setZ(gb) : resetZ(gb);
+  ((read_memory(gb, gb->r.HL.val) ^ 0x01 ^ hl) & 0x10) ? setH(gb) : resetH(gb);
+  resetN(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 12;
+  gb->clock.m = 1;
+  gb->clock.t = 12;
 }
 
 // LD (HL), B
-void opcode_0x70(void)
+void opcode_0x70(GbContext *gb)
 {
-  write_memory(r.HL.val, r.BC.bytes.high);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.BC.bytes.high);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (HL), C
-void opcode_0x71(void)
+void opcode_0x71(GbContext *gb)
 {
-  write_memory(r.HL.val, r.BC.bytes.low);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.BC.bytes.low);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (HL), D
-void opcode_0x72(void)
+void opcode_0x72(GbContext *gb)
 {
-  write_memory(r.HL.val, r.DE.bytes.high);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.DE.bytes.high);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (HL), E
-void opcode_0x73(void)
+void opcode_0x73(GbContext *gb)
 {
-  write_memory(r.HL.val, r.DE.bytes.low);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.DE.bytes.low);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (HL), H
-void opcode_0x74(void)
+void opcode_0x74(GbContext *gb)
 {
-  write_memory(r.HL.val, r.HL.bytes.high);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.HL.bytes.high);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (HL), L
-void opcode_0x75(void)
+void opcode_0x75(GbContext *gb)
 {
-  write_memory(r.HL.val, r.HL.bytes.low);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.HL.bytes.low);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD (HL), A
-void opcode_0x77(void)
+void opcode_0x77(GbContext *gb)
 {
-  write_memory(r.HL.val, r.AF.bytes.high);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  write_memory(gb, gb->r.HL.val, gb->r.AF.bytes.high);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD BC, d16
-void opcode_0x01(void)
+void opcode_0x01(GbContext *gb)
 {
-  r.BC.val = read_word();
-  my_clock.m = 3;
-  my_clock.t = 12;
+  gb->r.BC.val = read_word(gb);
+  gb->clock.m = 3;
+  gb->clock.t = 12;
 }
 
 // LD (a16), SP
-void opcode_0x08(void)
+void opcode_0x08(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  write_memory(addr, r.SP.val & 0xFF);
-  write_memory(addr + 1, r.SP.val >> 8);
+  uint16_t addr = read_word(gb);
+  write_memory(gb, addr, gb->r.SP.val & 0xFF);
+  write_memory(gb, addr + 1, gb->r.SP.val >> 8);
 
-  my_clock.m = 3;
-  my_clock.t = 20;
+  gb->clock.m = 3;
+  gb->clock.t = 20;
 }
 
 // LD DE, d16
-void opcode_0x11(void)
+void opcode_0x11(GbContext *gb)
 {
-  r.DE.val = read_word();
-  my_clock.m = 3;
-  my_clock.t = 12;
+  gb->r.DE.val = read_word(gb);
+  gb->clock.m = 3;
+  gb->clock.t = 12;
 }
 
 // LD A,(BC)
-void opcode_0x0a(void)
+void opcode_0x0a(GbContext *gb)
 {
-  r.AF.bytes.high = read_memory(r.BC.val);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->r.AF.bytes.high = read_memory(gb, gb->r.BC.val);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD A,(DE)
-void opcode_0x1a(void)
+void opcode_0x1a(GbContext *gb)
 {
-  r.AF.bytes.high = read_memory(r.DE.val);
-  my_clock.m = 1;
-  my_clock.t = 8;
+  gb->r.AF.bytes.high = read_memory(gb, gb->r.DE.val);
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD A,(HL+)
-void opcode_0x2a(void) { r.AF.bytes.high = read_memory(r.HL.val); r.HL.val++; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x36(void) { write_memory(r.HL.val, read_byte()); my_clock.m = 2; my_clock.t = 12; }
-void opcode_0x46(void) { load(&r.BC.bytes.high, read_memory(r.HL.val)); my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x56(void) { load(&r.DE.bytes.high, read_memory(r.HL.val)); my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x66(void) { load(&r.HL.bytes.high, read_memory(r.HL.val)); my_clock.m = 1; my_clock.t = 8; }
+void opcode_0x2a(GbContext *gb) { gb->r.AF.bytes.high = read_memory(gb, gb->r.HL.val); gb->r.HL.val++; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x36(GbContext *gb) { write_memory(gb, gb->r.HL.val, read_byte(gb)); gb->clock.m = 2; gb->clock.t = 12; }
+void opcode_0x46(GbContext *gb) { load(gb, &gb->r.BC.bytes.high, read_memory(gb, gb->r.HL.val)); gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x56(GbContext *gb) { load(gb, &gb->r.DE.bytes.high, read_memory(gb, gb->r.HL.val)); gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x66(GbContext *gb) { load(gb, &gb->r.HL.bytes.high, read_memory(gb, gb->r.HL.val)); gb->clock.m = 1; gb->clock.t = 8; }
 
 // DEC OPS
-void opcode_0x0b(void) { r.BC.val--; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x1b(void) { r.DE.val--; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x2b(void) { r.HL.val--; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x3b(void) { r.SP.val--; my_clock.m = 1; my_clock.t = 8; }
+void opcode_0x0b(GbContext *gb) { gb->r.BC.val--; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x1b(GbContext *gb) { gb->r.DE.val--; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x2b(GbContext *gb) { gb->r.HL.val--; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x3b(GbContext *gb) { gb->r.SP.val--; gb->clock.m = 1; gb->clock.t = 8; }
 
 // LD OPS
-void opcode_0x3a(void) { r.AF.bytes.high = read_memory(r.HL.val); r.HL.val--; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x21(void) { r.HL.val = read_word(); my_clock.m = 3; my_clock.t = 12; }
-void opcode_0x31(void) { r.SP.val = read_word(); my_clock.m = 3; my_clock.t = 12; }
-void opcode_0x06(void) { r.BC.bytes.high = read_byte(); my_clock.m = 2; my_clock.t = 8; }
-void opcode_0x16(void) { r.DE.bytes.high = read_byte(); my_clock.m = 2; my_clock.t = 8; }
-void opcode_0x26(void) { r.HL.bytes.high = read_byte(); my_clock.m = 2; my_clock.t = 8; }
-void opcode_0xf9(void) { r.SP.val = r.HL.val; my_clock.m = 1; my_clock.t = 8; }
+void opcode_0x3a(GbContext *gb) { gb->r.AF.bytes.high = read_memory(gb, gb->r.HL.val); gb->r.HL.val--; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x21(GbContext *gb) { gb->r.HL.val = read_word(gb); gb->clock.m = 3; gb->clock.t = 12; }
+void opcode_0x31(GbContext *gb) { gb->r.SP.val = read_word(gb); gb->clock.m = 3; gb->clock.t = 12; }
+void opcode_0x06(GbContext *gb) { gb->r.BC.bytes.high = read_byte(gb); gb->clock.m = 2; gb->clock.t = 8; }
+void opcode_0x16(GbContext *gb) { gb->r.DE.bytes.high = read_byte(gb); gb->clock.m = 2; gb->clock.t = 8; }
+void opcode_0x26(GbContext *gb) { gb->r.HL.bytes.high = read_byte(gb); gb->clock.m = 2; gb->clock.t = 8; }
+void opcode_0xf9(GbContext *gb) { gb->r.SP.val = gb->r.HL.val; gb->clock.m = 1; gb->clock.t = 8; }
 
 // ADD OPS
-void opcode_0x09(void) { add_16_op(&r.HL.val, r.BC.val); }
-void opcode_0x19(void) { add_16_op(&r.HL.val, r.DE.val); }
-void opcode_0x29(void) { add_16_op(&r.HL.val, r.HL.val); }
-void opcode_0x39(void) { add_16_op(&r.HL.val, r.SP.val); }
+void opcode_0x09(GbContext *gb) { add_16_op(gb, &gb->r.HL.val, gb->r.BC.val); }
+void opcode_0x19(GbContext *gb) { add_16_op(gb, &gb->r.HL.val, gb->r.DE.val); }
+void opcode_0x29(GbContext *gb) { add_16_op(gb, &gb->r.HL.val, gb->r.HL.val); }
+void opcode_0x39(GbContext *gb) { add_16_op(gb, &gb->r.HL.val, gb->r.SP.val); }
 
 // ADC OPS
-void opcode_0x88(void) { adc_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0x89(void) { adc_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0x8a(void) { adc_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0x8b(void) { adc_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0x8c(void) { adc_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0x8d(void) { adc_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0x8e(void)
+void opcode_0x88(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0x89(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0x8a(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0x8b(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0x8c(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0x8d(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0x8e(GbContext *gb)
 {
-  adc_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  adc_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0x8f(void) { adc_op(&r.AF.bytes.high, r.AF.bytes.high); }
+void opcode_0x8f(GbContext *gb) { adc_op(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
 
 // ADC A, d8
-void opcode_0xce(void)
+void opcode_0xce(GbContext *gb)
 {
-  adc_op(&r.AF.bytes.high, read_byte());
-  my_clock.m = 2;
-  my_clock.t = 8;
+  adc_op(gb, &gb->r.AF.bytes.high, read_byte(gb));
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
 
 // ADD OPS
-void opcode_0x80(void) { add_8_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0x81(void) { add_8_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0x82(void) { add_8_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0x83(void) { add_8_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0x84(void) { add_8_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0x85(void) { add_8_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0x86(void)
+void opcode_0x80(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0x81(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0x82(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0x83(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0x84(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0x85(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0x86(GbContext *gb)
 {
-  add_8_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  add_8_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0x87(void) { add_8_op(&r.AF.bytes.high, r.AF.bytes.high); }
-void opcode_0xc6(void) { add_8_op(&r.AF.bytes.high, read_byte()); }
+void opcode_0x87(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
+void opcode_0xc6(GbContext *gb) { add_8_op(gb, &gb->r.AF.bytes.high, read_byte(gb)); }
 
 // SUB OPS
-void opcode_0x90(void) { sub_8_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0x91(void) { sub_8_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0x92(void) { sub_8_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0x93(void) { sub_8_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0x94(void) { sub_8_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0x95(void) { sub_8_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0x96(void)
+void opcode_0x90(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0x91(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0x92(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0x93(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0x94(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0x95(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0x96(GbContext *gb)
 {
-  sub_8_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  sub_8_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0x97(void) { r.AF.bytes.high = 0; resetH(); resetC(); setZ(); setN(); my_clock.m = 1; my_clock.t = 4; }
-void opcode_0xd6(void) { sub_8_op(&r.AF.bytes.high, read_byte()); }
+void opcode_0x97(GbContext *gb) { gb->r.AF.bytes.high = 0; resetH(gb); resetC(gb); setZ(gb); setN(gb); gb->clock.m = 1; gb->clock.t = 4; }
+void opcode_0xd6(GbContext *gb) { sub_8_op(gb, &gb->r.AF.bytes.high, read_byte(gb)); }
 
 // SBC OPS
-void opcode_0x98(void) { sbc_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0x99(void) { sbc_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0x9a(void) { sbc_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0x9b(void) { sbc_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0x9c(void) { sbc_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0x9d(void) { sbc_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0x9e(void)
+void opcode_0x98(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0x99(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0x9a(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0x9b(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0x9c(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0x9d(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0x9e(GbContext *gb)
 {
-  sbc_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  sbc_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0x9f(void) { sbc_op(&r.AF.bytes.high, r.AF.bytes.high); }
-void opcode_0xde(void) { sbc_op(&r.AF.bytes.high, read_byte()); }
+void opcode_0x9f(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
+void opcode_0xde(GbContext *gb) { sbc_op(gb, &gb->r.AF.bytes.high, read_byte(gb)); }
 
 // XOR OPS
-void opcode_0xa8(void) { xor_8_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0xa9(void) { xor_8_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0xaa(void) { xor_8_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0xab(void) { xor_8_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0xac(void) { xor_8_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0xad(void) { xor_8_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0xae(void)
+void opcode_0xa8(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0xa9(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0xaa(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0xab(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0xac(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0xad(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0xae(GbContext *gb)
 {
-  xor_8_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  xor_8_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0xaf(void) { xor_8_op(&r.AF.bytes.high, r.AF.bytes.high); }
-void opcode_0xee(void) { xor_8_op(&r.AF.bytes.high, read_byte()); }
+void opcode_0xaf(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
+void opcode_0xee(GbContext *gb) { xor_8_op(gb, &gb->r.AF.bytes.high, read_byte(gb)); }
 
 // AND OPS
-void opcode_0xe6(void)
+void opcode_0xe6(GbContext *gb)
 {
-  and_op(&r.AF.bytes.high, read_byte());
-  my_clock.m = 2;
-  my_clock.t = 8;
+  and_op(gb, &gb->r.AF.bytes.high, read_byte(gb));
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
-void opcode_0xa0(void) { and_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0xa1(void) { and_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0xa2(void) { and_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0xa3(void) { and_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0xa4(void) { and_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0xa5(void) { and_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0xa6(void)
+void opcode_0xa0(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0xa1(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0xa2(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0xa3(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0xa4(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0xa5(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0xa6(GbContext *gb)
 {
-  and_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  and_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0xa7(void) { and_op(&r.AF.bytes.high, r.AF.bytes.high); }
+void opcode_0xa7(GbContext *gb) { and_op(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
 
 // OR OPS
-void opcode_0xf6(void)
+void opcode_0xf6(GbContext *gb)
 {
-  or_op(&r.AF.bytes.high, read_byte());
-  my_clock.m = 2;
-  my_clock.t = 8;
+  or_op(gb, &gb->r.AF.bytes.high, read_byte(gb));
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
-void opcode_0xb0(void) { or_op(&r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0xb1(void) { or_op(&r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0xb2(void) { or_op(&r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0xb3(void) { or_op(&r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0xb4(void) { or_op(&r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0xb5(void) { or_op(&r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0xb6(void)
+void opcode_0xb0(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0xb1(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0xb2(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0xb3(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0xb4(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0xb5(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0xb6(GbContext *gb)
 {
-  or_op(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  or_op(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0xb7(void) { or_op(&r.AF.bytes.high, r.AF.bytes.high); }
+void opcode_0xb7(GbContext *gb) { or_op(gb, &gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
 
 // CP OPS
-void opcode_0xfe(void)
+void opcode_0xfe(GbContext *gb)
 {
-  cp_op(r.AF.bytes.high, read_byte());
-  my_clock.m = 2;
-  my_clock.t = 8;
+  cp_op(gb, gb->r.AF.bytes.high, read_byte(gb));
+  gb->clock.m = 2;
+  gb->clock.t = 8;
 }
-void opcode_0xb8(void) { cp_op(r.AF.bytes.high, r.BC.bytes.high); }
-void opcode_0xb9(void) { cp_op(r.AF.bytes.high, r.BC.bytes.low); }
-void opcode_0xba(void) { cp_op(r.AF.bytes.high, r.DE.bytes.high); }
-void opcode_0xbb(void) { cp_op(r.AF.bytes.high, r.DE.bytes.low); }
-void opcode_0xbc(void) { cp_op(r.AF.bytes.high, r.HL.bytes.high); }
-void opcode_0xbd(void) { cp_op(r.AF.bytes.high, r.HL.bytes.low); }
-void opcode_0xbe(void)
+void opcode_0xb8(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.BC.bytes.high); }
+void opcode_0xb9(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.BC.bytes.low); }
+void opcode_0xba(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.DE.bytes.high); }
+void opcode_0xbb(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.DE.bytes.low); }
+void opcode_0xbc(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.HL.bytes.high); }
+void opcode_0xbd(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.HL.bytes.low); }
+void opcode_0xbe(GbContext *gb)
 {
-  cp_op(r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  cp_op(gb, gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
-void opcode_0xbf(void) { cp_op(r.AF.bytes.high, r.AF.bytes.high); }
+void opcode_0xbf(GbContext *gb) { cp_op(gb, gb->r.AF.bytes.high, gb->r.AF.bytes.high); }
 
 // (a16) <- A
-void opcode_0xea(void)
+void opcode_0xea(GbContext *gb)
 {
-  write_memory(read_word(), r.AF.bytes.high);
+  write_memory(gb, read_word(gb), gb->r.AF.bytes.high);
 
-  my_clock.m = 3;
-  my_clock.t = 16;
+  gb->clock.m = 3;
+  gb->clock.t = 16;
 }
 
 // A <- (a16)
-void opcode_0xfa(void)
+void opcode_0xfa(GbContext *gb)
 {
-  r.AF.bytes.high = read_memory(read_word());
+  gb->r.AF.bytes.high = read_memory(gb, read_word(gb));
 
-  my_clock.m = 3;
-  my_clock.t = 16;
+  gb->clock.m = 3;
+  gb->clock.t = 16;
 }
 
 // JP a16
-void opcode_0xc3(void)
+void opcode_0xc3(GbContext *gb)
 {
-  r.PC.val = read_word();
+  gb->r.PC.val = read_word(gb);
 
-  my_clock.m = 3;
-  my_clock.t = 16;
+  gb->clock.m = 3;
+  gb->clock.t = 16;
 }
 
 // JP (HL) -> special behaviour!! :( means that PC = HL
-void opcode_0xe9(void)
+void opcode_0xe9(GbContext *gb)
 {
-  r.PC.val = r.HL.val;
+  gb->r.PC.val = gb->r.HL.val;
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // JP Z, a16
-void opcode_0xca(void)
+void opcode_0xca(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (getZ())
+  uint16_t addr = read_word(gb);
+  if (getZ(gb))
   {
-    r.PC.val = addr;
-    my_clock.t = 16;
+    gb->r.PC.val = addr;
+    gb->clock.t = 16;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // JP C, a16
-void opcode_0xda(void)
+void opcode_0xda(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (getC())
+  uint16_t addr = read_word(gb);
+  if (getC(gb))
   {
-    r.PC.val = addr;
-    my_clock.t = 16;
+    gb->r.PC.val = addr;
+    gb->clock.t = 16;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // JP NZ, a16
-void opcode_0xc2(void)
+void opcode_0xc2(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (!getZ())
+  uint16_t addr = read_word(gb);
+  if (!getZ(gb))
   {
-    r.PC.val = addr;
-    my_clock.t = 16;
+    gb->r.PC.val = addr;
+    gb->clock.t = 16;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // JP NC, a16
-void opcode_0xd2(void)
+void opcode_0xd2(GbContext *gb)
 {
-  uint16_t addr = read_word();
-  if (!getC())
+  uint16_t addr = read_word(gb);
+  if (!getC(gb))
   {
-    r.PC.val = addr;
-    my_clock.t = 16;
+    gb->r.PC.val = addr;
+    gb->clock.t = 16;
   }
   else
   {
-    my_clock.t = 12;
+    gb->clock.t = 12;
   }
-  my_clock.m = 3;
+  gb->clock.m = 3;
 }
 
 // ADD SP, r8
-void opcode_0xe8(void)
+void opcode_0xe8(GbContext *gb)
 {
-  int8_t tmp = read_byte();
-  uint16_t res = r.SP.val + tmp;
+  int8_t tmp = read_byte(gb);
+  uint16_t res = gb->r.SP.val + tmp;
 
-  ((r.SP.val ^ tmp ^ res) & 0x100) ? setC() : resetC();
-  ((r.SP.val ^ tmp ^ res) & 0x10) ? setH() : resetH();
+  ((gb->r.SP.val ^ tmp ^ res) & 0x100) ? setC(gb) : resetC(gb);
+  ((gb->r.SP.val ^ tmp ^ res) & 0x10) ? setH(gb) : resetH(gb);
 
-  resetZ();
-  resetN();
+  resetZ(gb);
+  resetN(gb);
 
-  r.SP.val = res;
-  my_clock.m = 2;
-  my_clock.t = 16;
+  gb->r.SP.val = res;
+  gb->clock.m = 2;
+  gb->clock.t = 16;
 }
 
 
 // ADD HL, (SP + r8)
-void opcode_0xf8(void)
+void opcode_0xf8(GbContext *gb)
 {
-  uint8_t tmp_u = read_byte();
+  uint8_t tmp_u = read_byte(gb);
   int8_t tmp = tmp_u;
-  uint16_t res = r.SP.val + tmp;
+  uint16_t res = gb->r.SP.val + tmp;
 
   // FLags set only on low bytes of SP. Use add_8_op to simulate add_op on temporary vars
-  add_8_op(&tmp_u, r.SP.bytes.low);
+  add_8_op(gb, &tmp_u, gb->r.SP.bytes.low);
 
-  resetZ();
-  resetN();
+  resetZ(gb);
+  resetN(gb);
 
-  r.HL.val = res;
+  gb->r.HL.val = res;
 
-  my_clock.m = 2;
-  my_clock.t = 12;
+  gb->clock.m = 2;
+  gb->clock.t = 12;
 }
 
 // JR r8
-void opcode_0x18(void)
+void opcode_0x18(GbContext *gb)
 {
-  r.PC.val += (int8_t)read_byte();
+  gb->r.PC.val += (int8_t)read_byte(gb);
 
-  my_clock.m = 2;
-  my_clock.t = 12;
+  gb->clock.m = 2;
+  gb->clock.t = 12;
 }
 
 // JR Z, r8
-void opcode_0x28(void)
+void opcode_0x28(GbContext *gb)
 {
-  int8_t addr = (int8_t)read_byte();
-  if (getZ())
+  int8_t addr = (int8_t)read_byte(gb);
+  if (getZ(gb))
   {
-    r.PC.val += addr;
-    my_clock.t = 12;
+    gb->r.PC.val += addr;
+    gb->clock.t = 12;
   }
   else
   {
-    my_clock.t = 8;
+    gb->clock.t = 8;
   }
 
-  my_clock.m = 2;
+  gb->clock.m = 2;
 }
 
 // JR C,r8
-void opcode_0x38(void)
+void opcode_0x38(GbContext *gb)
 {
-  int8_t addr = (int8_t)read_byte();
-  if (getC())
+  int8_t addr = (int8_t)read_byte(gb);
+  if (getC(gb))
   {
-    r.PC.val += addr;
-    my_clock.t = 12;
+    gb->r.PC.val += addr;
+    gb->clock.t = 12;
   }
   else
   {
-    my_clock.t = 8;
+    gb->clock.t = 8;
   }
 
-  my_clock.m = 2;
+  gb->clock.m = 2;
 }
 
 // JR NC,r8
-void opcode_0x30(void)
+void opcode_0x30(GbContext *gb)
 {
-  int8_t addr = (int8_t)read_byte();
-  if (!getC())
+  int8_t addr = (int8_t)read_byte(gb);
+  if (!getC(gb))
   {
-    r.PC.val += addr;
-    my_clock.t = 12;
+    gb->r.PC.val += addr;
+    gb->clock.t = 12;
   }
   else
   {
-    my_clock.t = 8;
+    gb->clock.t = 8;
   }
 
-  my_clock.m = 2;
+  gb->clock.m = 2;
 }
 
 // RRCA
-void opcode_0x0f(void)
+void opcode_0x0f(GbContext *gb)
 {
-  r.AF.bytes.high = ((r.AF.bytes.high >> 1) | ((r.AF.bytes.high & 1) << 7));
-  (r.AF.bytes.high > 0x7F) ? setC() : resetC();
+  gb->r.AF.bytes.high = ((gb->r.AF.bytes.high >> 1) | ((gb->r.AF.bytes.high & 1) << 7));
+  (gb->r.AF.bytes.high > 0x7F) ? setC(gb) : resetC(gb);
 
-  resetZ();
-  resetN();
-  resetH();
+  resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // RLCA
-void opcode_0x07(void)
+void opcode_0x07(GbContext *gb)
 {
-  (r.AF.bytes.high > 0x7F) ? setC() : resetC();
-  r.AF.bytes.high = ((r.AF.bytes.high << 1) | (r.AF.bytes.high >> 7));
+  (gb->r.AF.bytes.high > 0x7F) ? setC(gb) : resetC(gb);
+  gb->r.AF.bytes.high = ((gb->r.AF.bytes.high << 1) | (gb->r.AF.bytes.high >> 7));
 
-  resetZ();
-  resetN();
-  resetH();
+  resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // RLA
-void opcode_0x17(void)
+void opcode_0x17(GbContext *gb)
 {
-  uint8_t carry = getC();
-  (r.AF.bytes.high > 0x7F) ? setC() : resetC();
-  r.AF.bytes.high = ((r.AF.bytes.high << 1) | carry);
+  uint8_t carry = getC(gb);
+  (gb->r.AF.bytes.high > 0x7F) ? setC(gb) : resetC(gb);
+  gb->r.AF.bytes.high = ((gb->r.AF.bytes.high << 1) | carry);
 
-  resetZ();
-  resetN();
-  resetH();
+  resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // RRA
-void opcode_0x1f(void)
+void opcode_0x1f(GbContext *gb)
 {
-  uint8_t carry = (getC() << 7);
-  (r.AF.bytes.high & 1) ? setC() : resetC();
-  r.AF.bytes.high = ((r.AF.bytes.high >> 1) | carry);
+  uint8_t carry = (getC(gb) << 7);
+  (gb->r.AF.bytes.high & 1) ? setC(gb) : resetC(gb);
+  gb->r.AF.bytes.high = ((gb->r.AF.bytes.high >> 1) | carry);
 
-  resetZ();
-  resetN();
-  resetH();
+  resetZ(gb);
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // DEC OPS
-void opcode_0x0d(void) { dec_op(&r.BC.bytes.low); }
-void opcode_0x1d(void) { dec_op(&r.DE.bytes.low); }
-void opcode_0x2d(void) { dec_op(&r.HL.bytes.low); }
-void opcode_0x3d(void) { dec_op(&r.AF.bytes.high); }
-void opcode_0x05(void) { dec_op(&r.BC.bytes.high); }
-void opcode_0x15(void) { dec_op(&r.DE.bytes.high); }
-void opcode_0x25(void) { dec_op(&r.HL.bytes.high); }
-void opcode_0x35(void)
+void opcode_0x0d(GbContext *gb) { dec_op(gb, &gb->r.BC.bytes.low); }
+void opcode_0x1d(GbContext *gb) { dec_op(gb, &gb->r.DE.bytes.low); }
+void opcode_0x2d(GbContext *gb) { dec_op(gb, &gb->r.HL.bytes.low); }
+void opcode_0x3d(GbContext *gb) { dec_op(gb, &gb->r.AF.bytes.high); }
+void opcode_0x05(GbContext *gb) { dec_op(gb, &gb->r.BC.bytes.high); }
+void opcode_0x15(GbContext *gb) { dec_op(gb, &gb->r.DE.bytes.high); }
+void opcode_0x25(GbContext *gb) { dec_op(gb, &gb->r.HL.bytes.high); }
+void opcode_0x35(GbContext *gb)
 {
-  uint8_t res = read_memory(r.HL.val) - 1;
-  (res == 0) ? setZ() : resetZ();
-  ((res & 0xF) == 0xF) ? setH() : resetH();
-  setN();
+  uint8_t res = read_memory(gb, gb->r.HL.val) - 1;
+  (res == 0) ? setZ(gb) : resetZ(gb);
+  ((res & 0xF) == 0xF) ? setH(gb) : resetH(gb);
+  setN(gb);
 
-  write_memory(r.HL.val, res);
+  write_memory(gb, gb->r.HL.val, res);
 
-  my_clock.m = 1;
-  my_clock.t = 12;
+  gb->clock.m = 1;
+  gb->clock.t = 12;
 }
 
 // INC OPS
-void opcode_0x03(void) { r.BC.val++; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x13(void) { r.DE.val++; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x23(void) { r.HL.val++; my_clock.m = 1; my_clock.t = 8; }
-void opcode_0x33(void) { r.SP.val++; my_clock.m = 1; my_clock.t = 8; }
+void opcode_0x03(GbContext *gb) { gb->r.BC.val++; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x13(GbContext *gb) { gb->r.DE.val++; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x23(GbContext *gb) { gb->r.HL.val++; gb->clock.m = 1; gb->clock.t = 8; }
+void opcode_0x33(GbContext *gb) { gb->r.SP.val++; gb->clock.m = 1; gb->clock.t = 8; }
 
 // SCF
-void opcode_0x37(void) { setC(); resetN(); resetH(); my_clock.m = 1; my_clock.t = 4; }
+void opcode_0x37(GbContext *gb) { setC(gb); resetN(gb); resetH(gb); gb->clock.m = 1; gb->clock.t = 4; }
 
 // RET
-void opcode_0xc9(void) { pop_op(&r.PC.val); my_clock.m = 1; my_clock.t = 16; }
+void opcode_0xc9(GbContext *gb) { pop_op(gb, &gb->r.PC.val); gb->clock.m = 1; gb->clock.t = 16; }
 
 // RETI (return then enable interupt)
-void opcode_0xd9(void) { opcode_0xc9(); r.ime = 1; }
+void opcode_0xd9(GbContext *gb) { opcode_0xc9(gb); gb->r.ime = 1; }
 
 // RET OPS
-void opcode_0xc0(void) { ret_cond_op(!getZ()); }
-void opcode_0xc8(void) { ret_cond_op(getZ()); }
-void opcode_0xd0(void) { ret_cond_op(!getC()); }
-void opcode_0xd8(void) { ret_cond_op(getC()); }
+void opcode_0xc0(GbContext *gb) { ret_cond_op(gb, !getZ(gb)); }
+void opcode_0xc8(GbContext *gb) { ret_cond_op(gb, getZ(gb)); }
+void opcode_0xd0(GbContext *gb) { ret_cond_op(gb, !getC(gb)); }
+void opcode_0xd8(GbContext *gb) { ret_cond_op(gb, getC(gb)); }
 
 // LDH (a8), A
-void opcode_0xe0(void)
+void opcode_0xe0(GbContext *gb)
 {
-  uint16_t addr = 0xFF00 + read_byte();
-  write_memory(addr, r.AF.bytes.high);
+  uint16_t addr = 0xFF00 + read_byte(gb);
+  write_memory(gb, addr, gb->r.AF.bytes.high);
 
-  my_clock.m = 2;
-  my_clock.t = 12;
+  gb->clock.m = 2;
+  gb->clock.t = 12;
 }
 
 // LDH A, (a8)
-void opcode_0xf0(void)
+void opcode_0xf0(GbContext *gb)
 {
-  uint16_t addr = 0xFF00 + read_byte();
-  r.AF.bytes.high = read_memory(addr);
+  uint16_t addr = 0xFF00 + read_byte(gb);
+  gb->r.AF.bytes.high = read_memory(gb, addr);
 
-  my_clock.m = 2;
-  my_clock.t = 12;
+  gb->clock.m = 2;
+  gb->clock.t = 12;
 }
 
 // DI
-void opcode_0xf3(void)
+void opcode_0xf3(GbContext *gb)
 {
-  r.ime = 0;
+  gb->r.ime = 0;
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // EI
-void opcode_0xfb(void)
+void opcode_0xfb(GbContext *gb)
 {
-  r.ime = 1;
+  gb->r.ime = 1;
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // CPL
-void opcode_0x2f(void)
+void opcode_0x2f(GbContext *gb)
 {
-  r.AF.bytes.high ^= 0xFF;
-  setN();
-  setH();
+  gb->r.AF.bytes.high ^= 0xFF;
+  setN(gb);
+  setH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // CCF
-void opcode_0x3f(void)
+void opcode_0x3f(GbContext *gb)
 {
-  getC() ? resetC() : setC(); // Inverse Carry flag
-  resetN();
-  resetH();
+  getC(gb) ? resetC(gb) : setC(gb); // Inverse Carry flag
+  resetN(gb);
+  resetH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
 // RST OPS
-void opcode_0xc7(void) { rst_op(0); }
-void opcode_0xcf(void) { rst_op(0x08); }
-void opcode_0xd7(void) { rst_op(0x10); }
-void opcode_0xdf(void) { rst_op(0x18); }
-void opcode_0xe7(void) { rst_op(0x20); }
-void opcode_0xef(void) { rst_op(0x28); }
-void opcode_0xf7(void) { rst_op(0x30); }
-void opcode_0xff(void) { rst_op(0x38); }
+void opcode_0xc7(GbContext *gb) { rst_op(gb, 0); }
+void opcode_0xcf(GbContext *gb) { rst_op(gb, 0x08); }
+void opcode_0xd7(GbContext *gb) { rst_op(gb, 0x10); }
+void opcode_0xdf(GbContext *gb) { rst_op(gb, 0x18); }
+void opcode_0xe7(GbContext *gb) { rst_op(gb, 0x20); }
+void opcode_0xef(GbContext *gb) { rst_op(gb, 0x28); }
+void opcode_0xf7(GbContext *gb) { rst_op(gb, 0x30); }
+void opcode_0xff(GbContext *gb) { rst_op(gb, 0x38); }
 
 // LD C, (HL)
-void opcode_0x4e(void)
+void opcode_0x4e(GbContext *gb)
 {
-  load(&r.BC.bytes.low, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  load(gb, &gb->r.BC.bytes.low, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD E, (HL)
-void opcode_0x5e(void)
+void opcode_0x5e(GbContext *gb)
 {
-  load(&r.DE.bytes.low, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  load(gb, &gb->r.DE.bytes.low, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD L, (HL)
-void opcode_0x6e(void)
+void opcode_0x6e(GbContext *gb)
 {
-  load(&r.HL.bytes.low, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  load(gb, &gb->r.HL.bytes.low, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // LD A, (HL)
-void opcode_0x7e(void)
+void opcode_0x7e(GbContext *gb)
 {
-  load(&r.AF.bytes.high, read_memory(r.HL.val));
-  my_clock.m = 1;
-  my_clock.t = 8;
+  load(gb, &gb->r.AF.bytes.high, read_memory(gb, gb->r.HL.val));
+  gb->clock.m = 1;
+  gb->clock.t = 8;
 }
 
 // DAA
-void opcode_0x27(void)
+void opcode_0x27(GbContext *gb)
 {
-  if (!getN())
+  if (!getN(gb))
   {
-    if (getC() || (r.AF.bytes.high > 0x99))
+    if (getC(gb) || (gb->r.AF.bytes.high > 0x99))
     {
-      r.AF.bytes.high += 0x60;
-      setC();
+      gb->r.AF.bytes.high += 0x60;
+      setC(gb);
     }
-    if (getH() || ((r.AF.bytes.high & 0x0F) > 0x09))
+    if (getH(gb) || ((gb->r.AF.bytes.high & 0x0F) > 0x09))
     {
-			r.AF.bytes.high += 0x6;
+			gb->r.AF.bytes.high += 0x6;
     }
 	}
   else
   {
-    if (getC())
+    if (getC(gb))
     {
-      r.AF.bytes.high -= 0x60;
+      gb->r.AF.bytes.high -= 0x60;
     }
-    if (getH())
+    if (getH(gb))
     {
-  		r.AF.bytes.high -= 0x6;
+  		gb->r.AF.bytes.high -= 0x6;
     }
   }
 
-  (r.AF.bytes.high == 0) ? setZ() : resetZ();
-  resetH();
+  (gb->r.AF.bytes.high == 0) ? setZ(gb) : resetZ(gb);
+  resetH(gb);
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
 }
 
-// HALT
-// TODO: Handle halt bug
-void opcode_0x76(void)
+// HALT, not entered when an enabled interupt is already pending: there is
+// nothing to wait for. The halt bug's second read of the next byte with IME
+// off is not emulated.
+void opcode_0x76(GbContext *gb)
 {
-  MMU.HALT = 1;
+  if (!(gb->mmu.memory[0xFF0F] & gb->mmu.memory[0xFFFF] & 0x1F))
+    gb->mmu.HALT = 1;
 
-  my_clock.m = 1;
-  my_clock.t = 4;
+  gb->clock.m = 1;
+  gb->clock.t = 4;
+}
+
+// The (HL) forms work on the memory map in place, flag the page, the tile
+// and the palettes as written
+static uint8_t *hl_byte(GbContext *gb)
+{
+  MARK_DIRTY(gb, gb->r.HL.val);
+  TILE_WRITE(gb, gb->r.HL.val);
+  PALETTE_WRITE(gb, gb->r.HL.val);
+  return &gb->mmu.memory[gb->r.HL.val];
 }
 
 // RLC OPS
-void prefix_0x00(void) { rlc_op(&r.BC.bytes.high); }
-void prefix_0x01(void) { rlc_op(&r.BC.bytes.low); }
-void prefix_0x02(void) { rlc_op(&r.DE.bytes.high); }
-void prefix_0x03(void) { rlc_op(&r.DE.bytes.low); }
-void prefix_0x04(void) { rlc_op(&r.HL.bytes.high); }
-void prefix_0x05(void) { rlc_op(&r.HL.bytes.low); }
-void prefix_0x06(void) { rlc_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x07(void) { rlc_op(&r.AF.bytes.high); }
+void prefix_0x00(GbContext *gb) { rlc_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x01(GbContext *gb) { rlc_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x02(GbContext *gb) { rlc_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x03(GbContext *gb) { rlc_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x04(GbContext *gb) { rlc_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x05(GbContext *gb) { rlc_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x06(GbContext *gb) { rlc_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x07(GbContext *gb) { rlc_op(gb, &gb->r.AF.bytes.high); }
 
 // RRC OPS
-void prefix_0x08(void) { rrc_op(&r.BC.bytes.high); }
-void prefix_0x09(void) { rrc_op(&r.BC.bytes.low); }
-void prefix_0x0a(void) { rrc_op(&r.DE.bytes.high); }
-void prefix_0x0b(void) { rrc_op(&r.DE.bytes.low); }
-void prefix_0x0c(void) { rrc_op(&r.HL.bytes.high); }
-void prefix_0x0d(void) { rrc_op(&r.HL.bytes.low); }
-void prefix_0x0e(void) { rrc_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x0f(void) { rrc_op(&r.AF.bytes.high); }
+void prefix_0x08(GbContext *gb) { rrc_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x09(GbContext *gb) { rrc_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x0a(GbContext *gb) { rrc_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x0b(GbContext *gb) { rrc_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x0c(GbContext *gb) { rrc_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x0d(GbContext *gb) { rrc_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x0e(GbContext *gb) { rrc_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x0f(GbContext *gb) { rrc_op(gb, &gb->r.AF.bytes.high); }
 
 // RL OPS
-void prefix_0x10(void) { rl_op(&r.BC.bytes.high); }
-void prefix_0x11(void) { rl_op(&r.BC.bytes.low); }
-void prefix_0x12(void) { rl_op(&r.DE.bytes.high); }
-void prefix_0x13(void) { rl_op(&r.DE.bytes.low); }
-void prefix_0x14(void) { rl_op(&r.HL.bytes.high); }
-void prefix_0x15(void) { rl_op(&r.HL.bytes.low); }
-void prefix_0x16(void) { rl_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x17(void) { rl_op(&r.AF.bytes.high); }
+void prefix_0x10(GbContext *gb) { rl_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x11(GbContext *gb) { rl_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x12(GbContext *gb) { rl_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x13(GbContext *gb) { rl_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x14(GbContext *gb) { rl_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x15(GbContext *gb) { rl_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x16(GbContext *gb) { rl_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x17(GbContext *gb) { rl_op(gb, &gb->r.AF.bytes.high); }
 
 // RR OPS
-void prefix_0x18(void) { rr_op(&r.BC.bytes.high); }
-void prefix_0x19(void) { rr_op(&r.BC.bytes.low); }
-void prefix_0x1a(void) { rr_op(&r.DE.bytes.high); }
-void prefix_0x1b(void) { rr_op(&r.DE.bytes.low); }
-void prefix_0x1c(void) { rr_op(&r.HL.bytes.high); }
-void prefix_0x1d(void) { rr_op(&r.HL.bytes.low); }
-void prefix_0x1e(void) { rr_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x1f(void) { rr_op(&r.AF.bytes.high); }
+void prefix_0x18(GbContext *gb) { rr_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x19(GbContext *gb) { rr_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x1a(GbContext *gb) { rr_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x1b(GbContext *gb) { rr_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x1c(GbContext *gb) { rr_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x1d(GbContext *gb) { rr_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x1e(GbContext *gb) { rr_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x1f(GbContext *gb) { rr_op(gb, &gb->r.AF.bytes.high); }
 
 // SLA OPS
-void prefix_0x20(void) { sla_op(&r.BC.bytes.high); }
-void prefix_0x21(void) { sla_op(&r.BC.bytes.low); }
-void prefix_0x22(void) { sla_op(&r.DE.bytes.high); }
-void prefix_0x23(void) { sla_op(&r.DE.bytes.low); }
-void prefix_0x24(void) { sla_op(&r.HL.bytes.high); }
-void prefix_0x25(void) { sla_op(&r.HL.bytes.low); }
-void prefix_0x26(void) { sla_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x27(void) { sla_op(&r.AF.bytes.high); }
+void prefix_0x20(GbContext *gb) { sla_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x21(GbContext *gb) { sla_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x22(GbContext *gb) { sla_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x23(GbContext *gb) { sla_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x24(GbContext *gb) { sla_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x25(GbContext *gb) { sla_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x26(GbContext *gb) { sla_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x27(GbContext *gb) { sla_op(gb, &gb->r.AF.bytes.high); }
 
 // SRA OPS
-void prefix_0x28(void) { sra_op(&r.BC.bytes.high); }
-void prefix_0x29(void) { sra_op(&r.BC.bytes.low); }
-void prefix_0x2a(void) { sra_op(&r.DE.bytes.high); }
-void prefix_0x2b(void) { sra_op(&r.DE.bytes.low); }
-void prefix_0x2c(void) { sra_op(&r.HL.bytes.high); }
-void prefix_0x2d(void) { sra_op(&r.HL.bytes.low); }
-void prefix_0x2e(void) { sra_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x2f(void) { sra_op(&r.AF.bytes.high); }
+void prefix_0x28(GbContext *gb) { sra_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x29(GbContext *gb) { sra_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x2a(GbContext *gb) { sra_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x2b(GbContext *gb) { sra_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x2c(GbContext *gb) { sra_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x2d(GbContext *gb) { sra_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x2e(GbContext *gb) { sra_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x2f(GbContext *gb) { sra_op(gb, &gb->r.AF.bytes.high); }
 
 // SWAP OPS
-void prefix_0x30(void) { swap_op(&r.BC.bytes.high); }
-void prefix_0x31(void) { swap_op(&r.BC.bytes.low); }
-void prefix_0x32(void) { swap_op(&r.DE.bytes.high); }
-void prefix_0x33(void) { swap_op(&r.DE.bytes.low); }
-void prefix_0x34(void) { swap_op(&r.HL.bytes.high); }
-void prefix_0x35(void) { swap_op(&r.HL.bytes.low); }
-void prefix_0x36(void) { swap_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x37(void) { swap_op(&r.AF.bytes.high); }
+void prefix_0x30(GbContext *gb) { swap_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x31(GbContext *gb) { swap_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x32(GbContext *gb) { swap_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x33(GbContext *gb) { swap_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x34(GbContext *gb) { swap_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x35(GbContext *gb) { swap_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x36(GbContext *gb) { swap_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x37(GbContext *gb) { swap_op(gb, &gb->r.AF.bytes.high); }
 
 // SRL OPS
-void prefix_0x38(void) { srl_op(&r.BC.bytes.high); }
-void prefix_0x39(void) { srl_op(&r.BC.bytes.low); }
-void prefix_0x3a(void) { srl_op(&r.DE.bytes.high); }
-void prefix_0x3b(void) { srl_op(&r.DE.bytes.low); }
-void prefix_0x3c(void) { srl_op(&r.HL.bytes.high); }
-void prefix_0x3d(void) { srl_op(&r.HL.bytes.low); }
-void prefix_0x3e(void) { srl_op(&MMU.memory[r.HL.val]); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x3f(void) { srl_op(&r.AF.bytes.high); }
+void prefix_0x38(GbContext *gb) { srl_op(gb, &gb->r.BC.bytes.high); }
+void prefix_0x39(GbContext *gb) { srl_op(gb, &gb->r.BC.bytes.low); }
+void prefix_0x3a(GbContext *gb) { srl_op(gb, &gb->r.DE.bytes.high); }
+void prefix_0x3b(GbContext *gb) { srl_op(gb, &gb->r.DE.bytes.low); }
+void prefix_0x3c(GbContext *gb) { srl_op(gb, &gb->r.HL.bytes.high); }
+void prefix_0x3d(GbContext *gb) { srl_op(gb, &gb->r.HL.bytes.low); }
+void prefix_0x3e(GbContext *gb) { srl_op(gb, hl_byte(gb)); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x3f(GbContext *gb) { srl_op(gb, &gb->r.AF.bytes.high); }
 
 // BIT PREFIX OPS
-void prefix_0x40(void) { bit_op(r.BC.bytes.high, 0); }
-void prefix_0x41(void) { bit_op(r.BC.bytes.low, 0); }
-void prefix_0x42(void) { bit_op(r.DE.bytes.high, 0); }
-void prefix_0x43(void) { bit_op(r.DE.bytes.low, 0); }
-void prefix_0x44(void) { bit_op(r.HL.bytes.high, 0); }
-void prefix_0x45(void) { bit_op(r.HL.bytes.low, 0); }
-void prefix_0x46(void) { bit_op(read_memory(r.HL.val), 0); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x47(void) { bit_op(r.AF.bytes.high, 0); }
-
-void prefix_0x48(void) { bit_op(r.BC.bytes.high, 1); }
-void prefix_0x49(void) { bit_op(r.BC.bytes.low, 1); }
-void prefix_0x4a(void) { bit_op(r.DE.bytes.high, 1); }
-void prefix_0x4b(void) { bit_op(r.DE.bytes.low, 1); }
-void prefix_0x4c(void) { bit_op(r.HL.bytes.high, 1); }
-void prefix_0x4d(void) { bit_op(r.HL.bytes.low, 1); }
-void prefix_0x4e(void) { bit_op(read_memory(r.HL.val), 1); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x4f(void) { bit_op(r.AF.bytes.high, 1); }
-
-void prefix_0x50(void) { bit_op(r.BC.bytes.high, 2); }
-void prefix_0x51(void) { bit_op(r.BC.bytes.low, 2); }
-void prefix_0x52(void) { bit_op(r.DE.bytes.high, 2); }
-void prefix_0x53(void) { bit_op(r.DE.bytes.low, 2); }
-void prefix_0x54(void) { bit_op(r.HL.bytes.high, 2); }
-void prefix_0x55(void) { bit_op(r.HL.bytes.low, 2); }
-void prefix_0x56(void) { bit_op(read_memory(r.HL.val), 2); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x57(void) { bit_op(r.AF.bytes.high, 2); }
-
-void prefix_0x58(void) { bit_op(r.BC.bytes.high, 3); }
-void prefix_0x59(void) { bit_op(r.BC.bytes.low, 3); }
-void prefix_0x5a(void) { bit_op(r.DE.bytes.high, 3); }
-void prefix_0x5b(void) { bit_op(r.DE.bytes.low, 3); }
-void prefix_0x5c(void) { bit_op(r.HL.bytes.high, 3); }
-void prefix_0x5d(void) { bit_op(r.HL.bytes.low, 3); }
-void prefix_0x5e(void) { bit_op(read_memory(r.HL.val), 3); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x5f(void) { bit_op(r.AF.bytes.high, 3); }
-
-void prefix_0x60(void) { bit_op(r.BC.bytes.high, 4); }
-void prefix_0x61(void) { bit_op(r.BC.bytes.low, 4); }
-void prefix_0x62(void) { bit_op(r.DE.bytes.high, 4); }
-void prefix_0x63(void) { bit_op(r.DE.bytes.low, 4); }
-void prefix_0x64(void) { bit_op(r.HL.bytes.high, 4); }
-void prefix_0x65(void) { bit_op(r.HL.bytes.low, 4); }
-void prefix_0x66(void) { bit_op(read_memory(r.HL.val), 4); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x67(void) { bit_op(r.AF.bytes.high, 4); }
-
-void prefix_0x68(void) { bit_op(r.BC.bytes.high, 5); }
-void prefix_0x69(void) { bit_op(r.BC.bytes.low, 5); }
-void prefix_0x6a(void) { bit_op(r.DE.bytes.high, 5); }
-void prefix_0x6b(void) { bit_op(r.DE.bytes.low, 5); }
-void prefix_0x6c(void) { bit_op(r.HL.bytes.high, 5); }
-void prefix_0x6d(void) { bit_op(r.HL.bytes.low, 5); }
-void prefix_0x6e(void) { bit_op(read_memory(r.HL.val), 5); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x6f(void) { bit_op(r.AF.bytes.high, 5); }
-
-void prefix_0x70(void) { bit_op(r.BC.bytes.high, 6); }
-void prefix_0x71(void) { bit_op(r.BC.bytes.low, 6); }
-void prefix_0x72(void) { bit_op(r.DE.bytes.high, 6); }
-void prefix_0x73(void) { bit_op(r.DE.bytes.low, 6); }
-void prefix_0x74(void) { bit_op(r.HL.bytes.high, 6); }
-void prefix_0x75(void) { bit_op(r.HL.bytes.low, 6); }
-void prefix_0x76(void) { bit_op(read_memory(r.HL.val), 6); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x77(void) { bit_op(r.AF.bytes.high, 6); }
-
-void prefix_0x78(void) { bit_op(r.BC.bytes.high, 7); }
-void prefix_0x79(void) { bit_op(r.BC.bytes.low, 7); }
-void prefix_0x7a(void) { bit_op(r.DE.bytes.high, 7); }
-void prefix_0x7b(void) { bit_op(r.DE.bytes.low, 7); }
-void prefix_0x7c(void) { bit_op(r.HL.bytes.high, 7); }
-void prefix_0x7d(void) { bit_op(r.HL.bytes.low, 7); }
-void prefix_0x7e(void) { bit_op(read_memory(r.HL.val), 7); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x7f(void) { bit_op(r.AF.bytes.high, 7); }
+void prefix_0x40(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 0); }
+void prefix_0x41(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 0); }
+void prefix_0x42(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 0); }
+void prefix_0x43(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 0); }
+void prefix_0x44(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 0); }
+void prefix_0x45(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 0); }
+void prefix_0x46(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 0); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x47(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 0); }
+
+void prefix_0x48(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 1); }
+void prefix_0x49(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 1); }
+void prefix_0x4a(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 1); }
+void prefix_0x4b(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 1); }
+void prefix_0x4c(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 1); }
+void prefix_0x4d(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 1); }
+void prefix_0x4e(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 1); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x4f(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 1); }
+
+void prefix_0x50(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 2); }
+void prefix_0x51(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 2); }
+void prefix_0x52(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 2); }
+void prefix_0x53(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 2); }
+void prefix_0x54(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 2); }
+void prefix_0x55(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 2); }
+void prefix_0x56(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 2); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x57(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 2); }
+
+void prefix_0x58(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 3); }
+void prefix_0x59(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 3); }
+void prefix_0x5a(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 3); }
+void prefix_0x5b(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 3); }
+void prefix_0x5c(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 3); }
+void prefix_0x5d(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 3); }
+void prefix_0x5e(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 3); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x5f(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 3); }
+
+void prefix_0x60(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 4); }
+void prefix_0x61(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 4); }
+void prefix_0x62(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 4); }
+void prefix_0x63(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 4); }
+void prefix_0x64(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 4); }
+void prefix_0x65(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 4); }
+void prefix_0x66(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 4); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x67(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 4); }
+
+void prefix_0x68(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 5); }
+void prefix_0x69(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 5); }
+void prefix_0x6a(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 5); }
+void prefix_0x6b(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 5); }
+void prefix_0x6c(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 5); }
+void prefix_0x6d(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 5); }
+void prefix_0x6e(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 5); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x6f(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 5); }
+
+void prefix_0x70(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 6); }
+void prefix_0x71(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 6); }
+void prefix_0x72(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 6); }
+void prefix_0x73(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 6); }
+void prefix_0x74(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 6); }
+void prefix_0x75(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 6); }
+void prefix_0x76(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 6); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x77(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 6); }
+
+void prefix_0x78(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.high, 7); }
+void prefix_0x79(GbContext *gb) { bit_op(gb, gb->r.BC.bytes.low, 7); }
+void prefix_0x7a(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.high, 7); }
+void prefix_0x7b(GbContext *gb) { bit_op(gb, gb->r.DE.bytes.low, 7); }
+void prefix_0x7c(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.high, 7); }
+void prefix_0x7d(GbContext *gb) { bit_op(gb, gb->r.HL.bytes.low, 7); }
+void prefix_0x7e(GbContext *gb) { bit_op(gb, read_memory(gb, gb->r.HL.val), 7); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x7f(GbContext *gb) { bit_op(gb, gb->r.AF.bytes.high, 7); }
 
 // RES PREFIX OPS
-void prefix_0x80(void) { res_op(&r.BC.bytes.high, 0); }
-void prefix_0x81(void) { res_op(&r.BC.bytes.low, 0); }
-void prefix_0x82(void) { res_op(&r.DE.bytes.high, 0); }
-void prefix_0x83(void) { res_op(&r.DE.bytes.low, 0); }
-void prefix_0x84(void) { res_op(&r.HL.bytes.high, 0); }
-void prefix_0x85(void) { res_op(&r.HL.bytes.low, 0); }
-void prefix_0x86(void) { res_op(&MMU.memory[r.HL.val], 0); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x87(void) { res_op(&r.AF.bytes.high, 0); }
-
-void prefix_0x88(void) { res_op(&r.BC.bytes.high, 1); }
-void prefix_0x89(void) { res_op(&r.BC.bytes.low, 1); }
-void prefix_0x8a(void) { res_op(&r.DE.bytes.high, 1); }
-void prefix_0x8b(void) { res_op(&r.DE.bytes.low, 1); }
-void prefix_0x8c(void) { res_op(&r.HL.bytes.high, 1); }
-void prefix_0x8d(void) { res_op(&r.HL.bytes.low, 1); }
-void prefix_0x8e(void) { res_op(&MMU.memory[r.HL.val], 1); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x8f(void) { res_op(&r.AF.bytes.high, 1); }
-
-void prefix_0x90(void) { res_op(&r.BC.bytes.high, 2); }
-void prefix_0x91(void) { res_op(&r.BC.bytes.low, 2); }
-void prefix_0x92(void) { res_op(&r.DE.bytes.high, 2); }
-void prefix_0x93(void) { res_op(&r.DE.bytes.low, 2); }
-void prefix_0x94(void) { res_op(&r.HL.bytes.high, 2); }
-void prefix_0x95(void) { res_op(&r.HL.bytes.low, 2); }
-void prefix_0x96(void) { res_op(&MMU.memory[r.HL.val], 2); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x97(void) { res_op(&r.AF.bytes.high, 2); }
-
-void prefix_0x98(void) { res_op(&r.BC.bytes.high, 3); }
-void prefix_0x99(void) { res_op(&r.BC.bytes.low, 3); }
-void prefix_0x9a(void) { res_op(&r.DE.bytes.high, 3); }
-void prefix_0x9b(void) { res_op(&r.DE.bytes.low, 3); }
-void prefix_0x9c(void) { res_op(&r.HL.bytes.high, 3); }
-void prefix_0x9d(void) { res_op(&r.HL.bytes.low, 3); }
-void prefix_0x9e(void) { res_op(&MMU.memory[r.HL.val], 3); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0x9f(void) { res_op(&r.AF.bytes.high, 3); }
-
-void prefix_0xa0(void) { res_op(&r.BC.bytes.high, 4); }
-void prefix_0xa1(void) { res_op(&r.BC.bytes.low, 4); }
-void prefix_0xa2(void) { res_op(&r.DE.bytes.high, 4); }
-void prefix_0xa3(void) { res_op(&r.DE.bytes.low, 4); }
-void prefix_0xa4(void) { res_op(&r.HL.bytes.high, 4); }
-void prefix_0xa5(void) { res_op(&r.HL.bytes.low, 4); }
-void prefix_0xa6(void) { res_op(&MMU.memory[r.HL.val], 4); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xa7(void) { res_op(&r.AF.bytes.high, 4); }
-
-void prefix_0xa8(void) { res_op(&r.BC.bytes.high, 5); }
-void prefix_0xa9(void) { res_op(&r.BC.bytes.low, 5); }
-void prefix_0xaa(void) { res_op(&r.DE.bytes.high, 5); }
-void prefix_0xab(void) { res_op(&r.DE.bytes.low, 5); }
-void prefix_0xac(void) { res_op(&r.HL.bytes.high, 5); }
-void prefix_0xad(void) { res_op(&r.HL.bytes.low, 5); }
-void prefix_0xae(void) { res_op(&MMU.memory[r.HL.val], 5); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xaf(void) { res_op(&r.AF.bytes.high, 5); }
-
-void prefix_0xb0(void) { res_op(&r.BC.bytes.high, 6); }
-void prefix_0xb1(void) { res_op(&r.BC.bytes.low, 6); }
-void prefix_0xb2(void) { res_op(&r.DE.bytes.high, 6); }
-void prefix_0xb3(void) { res_op(&r.DE.bytes.low, 6); }
-void prefix_0xb4(void) { res_op(&r.HL.bytes.high, 6); }
-void prefix_0xb5(void) { res_op(&r.HL.bytes.low, 6); }
-void prefix_0xb6(void) { res_op(&MMU.memory[r.HL.val], 6); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xb7(void) { res_op(&r.AF.bytes.high, 6); }
-
-void prefix_0xb8(void) { res_op(&r.BC.bytes.high, 7); }
-void prefix_0xb9(void) { res_op(&r.BC.bytes.low, 7); }
-void prefix_0xba(void) { res_op(&r.DE.bytes.high, 7); }
-void prefix_0xbb(void) { res_op(&r.DE.bytes.low, 7); }
-void prefix_0xbc(void) { res_op(&r.HL.bytes.high, 7); }
-void prefix_0xbd(void) { res_op(&r.HL.bytes.low, 7); }
-void prefix_0xbe(void) { res_op(&MMU.memory[r.HL.val], 7); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xbf(void) { res_op(&r.AF.bytes.high, 7); }
+void prefix_0x80(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 0); }
+void prefix_0x81(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 0); }
+void prefix_0x82(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 0); }
+void prefix_0x83(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 0); }
+void prefix_0x84(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 0); }
+void prefix_0x85(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 0); }
+void prefix_0x86(GbContext *gb) { res_op(gb, hl_byte(gb), 0); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x87(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 0); }
+
+void prefix_0x88(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 1); }
+void prefix_0x89(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 1); }
+void prefix_0x8a(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 1); }
+void prefix_0x8b(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 1); }
+void prefix_0x8c(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 1); }
+void prefix_0x8d(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 1); }
+void prefix_0x8e(GbContext *gb) { res_op(gb, hl_byte(gb), 1); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x8f(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 1); }
+
+void prefix_0x90(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 2); }
+void prefix_0x91(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 2); }
+void prefix_0x92(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 2); }
+void prefix_0x93(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 2); }
+void prefix_0x94(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 2); }
+void prefix_0x95(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 2); }
+void prefix_0x96(GbContext *gb) { res_op(gb, hl_byte(gb), 2); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x97(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 2); }
+
+void prefix_0x98(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 3); }
+void prefix_0x99(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 3); }
+void prefix_0x9a(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 3); }
+void prefix_0x9b(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 3); }
+void prefix_0x9c(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 3); }
+void prefix_0x9d(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 3); }
+void prefix_0x9e(GbContext *gb) { res_op(gb, hl_byte(gb), 3); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0x9f(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 3); }
+
+void prefix_0xa0(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 4); }
+void prefix_0xa1(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 4); }
+void prefix_0xa2(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 4); }
+void prefix_0xa3(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 4); }
+void prefix_0xa4(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 4); }
+void prefix_0xa5(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 4); }
+void prefix_0xa6(GbContext *gb) { res_op(gb, hl_byte(gb), 4); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xa7(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 4); }
+
+void prefix_0xa8(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 5); }
+void prefix_0xa9(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 5); }
+void prefix_0xaa(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 5); }
+void prefix_0xab(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 5); }
+void prefix_0xac(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 5); }
+void prefix_0xad(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 5); }
+void prefix_0xae(GbContext *gb) { res_op(gb, hl_byte(gb), 5); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xaf(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 5); }
+
+void prefix_0xb0(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 6); }
+void prefix_0xb1(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 6); }
+void prefix_0xb2(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 6); }
+void prefix_0xb3(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 6); }
+void prefix_0xb4(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 6); }
+void prefix_0xb5(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 6); }
+void prefix_0xb6(GbContext *gb) { res_op(gb, hl_byte(gb), 6); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xb7(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 6); }
+
+void prefix_0xb8(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.high, 7); }
+void prefix_0xb9(GbContext *gb) { res_op(gb, &gb->r.BC.bytes.low, 7); }
+void prefix_0xba(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.high, 7); }
+void prefix_0xbb(GbContext *gb) { res_op(gb, &gb->r.DE.bytes.low, 7); }
+void prefix_0xbc(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.high, 7); }
+void prefix_0xbd(GbContext *gb) { res_op(gb, &gb->r.HL.bytes.low, 7); }
+void prefix_0xbe(GbContext *gb) { res_op(gb, hl_byte(gb), 7); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xbf(GbContext *gb) { res_op(gb, &gb->r.AF.bytes.high, 7); }
 
 // SET PREFIX OPS
-void prefix_0xc0(void) { set_op(&r.BC.bytes.high, 0); }
-void prefix_0xc1(void) { set_op(&r.BC.bytes.low, 0); }
-void prefix_0xc2(void) { set_op(&r.DE.bytes.high, 0); }
-void prefix_0xc3(void) { set_op(&r.DE.bytes.low, 0); }
-void prefix_0xc4(void) { set_op(&r.HL.bytes.high, 0); }
-void prefix_0xc5(void) { set_op(&r.HL.bytes.low, 0); }
-void prefix_0xc6(void) { set_op(&MMU.memory[r.HL.val], 0); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xc7(void) { set_op(&r.AF.bytes.high, 0); }
-
-void prefix_0xc8(void) { set_op(&r.BC.bytes.high, 1); }
-void prefix_0xc9(void) { set_op(&r.BC.bytes.low, 1); }
-void prefix_0xca(void) { set_op(&r.DE.bytes.high, 1); }
-void prefix_0xcb(void) { set_op(&r.DE.bytes.low, 1); }
-void prefix_0xcc(void) { set_op(&r.HL.bytes.high, 1); }
-void prefix_0xcd(void) { set_op(&r.HL.bytes.low, 1); }
-void prefix_0xce(void) { set_op(&MMU.memory[r.HL.val], 1); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xcf(void) { set_op(&r.AF.bytes.high, 1); }
-
-void prefix_0xd0(void) { set_op(&r.BC.bytes.high, 2); }
-void prefix_0xd1(void) { set_op(&r.BC.bytes.low, 2); }
-void prefix_0xd2(void) { set_op(&r.DE.bytes.high, 2); }
-void prefix_0xd3(void) { set_op(&r.DE.bytes.low, 2); }
-void prefix_0xd4(void) { set_op(&r.HL.bytes.high, 2); }
-void prefix_0xd5(void) { set_op(&r.HL.bytes.low, 2); }
-void prefix_0xd6(void) { set_op(&MMU.memory[r.HL.val], 2); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xd7(void) { set_op(&r.AF.bytes.high, 2); }
-
-void prefix_0xd8(void) { set_op(&r.BC.bytes.high, 3); }
-void prefix_0xd9(void) { set_op(&r.BC.bytes.low, 3); }
-void prefix_0xda(void) { set_op(&r.DE.bytes.high, 3); }
-void prefix_0xdb(void) { set_op(&r.DE.bytes.low, 3); }
-void prefix_0xdc(void) { set_op(&r.HL.bytes.high, 3); }
-void prefix_0xdd(void) { set_op(&r.HL.bytes.low, 3); }
-void prefix_0xde(void) { set_op(&MMU.memory[r.HL.val], 3); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xdf(void) { set_op(&r.AF.bytes.high, 3); }
-
-void prefix_0xe0(void) { set_op(&r.BC.bytes.high, 4); }
-void prefix_0xe1(void) { set_op(&r.BC.bytes.low, 4); }
-void prefix_0xe2(void) { set_op(&r.DE.bytes.high, 4); }
-void prefix_0xe3(void) { set_op(&r.DE.bytes.low, 4); }
-void prefix_0xe4(void) { set_op(&r.HL.bytes.high, 4); }
-void prefix_0xe5(void) { set_op(&r.HL.bytes.low, 4); }
-void prefix_0xe6(void) { set_op(&MMU.memory[r.HL.val], 4); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xe7(void) { set_op(&r.AF.bytes.high, 4); }
-
-void prefix_0xe8(void) { set_op(&r.BC.bytes.high, 5); }
-void prefix_0xe9(void) { set_op(&r.BC.bytes.low, 5); }
-void prefix_0xea(void) { set_op(&r.DE.bytes.high, 5); }
-void prefix_0xeb(void) { set_op(&r.DE.bytes.low, 5); }
-void prefix_0xec(void) { set_op(&r.HL.bytes.high, 5); }
-void prefix_0xed(void) { set_op(&r.HL.bytes.low, 5); }
-void prefix_0xee(void) { set_op(&MMU.memory[r.HL.val], 5); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xef(void) { set_op(&r.AF.bytes.high, 5); }
-
-void prefix_0xf0(void) { set_op(&r.BC.bytes.high, 6); }
-void prefix_0xf1(void) { set_op(&r.BC.bytes.low, 6); }
-void prefix_0xf2(void) { set_op(&r.DE.bytes.high, 6); }
-void prefix_0xf3(void) { set_op(&r.DE.bytes.low, 6); }
-void prefix_0xf4(void) { set_op(&r.HL.bytes.high, 6); }
-void prefix_0xf5(void) { set_op(&r.HL.bytes.low, 6); }
-void prefix_0xf6(void) { set_op(&MMU.memory[r.HL.val], 6); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xf7(void) { set_op(&r.AF.bytes.high, 6); }
-
-void prefix_0xf8(void) { set_op(&r.BC.bytes.high, 7); }
-void prefix_0xf9(void) { set_op(&r.BC.bytes.low, 7); }
-void prefix_0xfa(void) { set_op(&r.DE.bytes.high, 7); }
-void prefix_0xfb(void) { set_op(&r.DE.bytes.low, 7); }
-void prefix_0xfc(void) { set_op(&r.HL.bytes.high, 7); }
-void prefix_0xfd(void) { set_op(&r.HL.bytes.low, 7); }
-void prefix_0xfe(void) { set_op(&MMU.memory[r.HL.val], 7); my_clock.m = 2; my_clock.t = 16; }
-void prefix_0xff(void) { set_op(&r.AF.bytes.high, 7); }
-
-void load_opcodes(void)
-{
-  Opcodes[0x00] = &opcode_0x00;
-  Opcodes[0x01] = &opcode_0x01;
-  Opcodes[0x02] = &opcode_0x02;
-  Opcodes[0x03] = &opcode_0x03;
-  Opcodes[0x04] = &opcode_0x04;
-  Opcodes[0x05] = &opcode_0x05;
-  Opcodes[0x06] = &opcode_0x06;
-  Opcodes[0x07] = &opcode_0x07;
-  Opcodes[0x08] = &opcode_0x08;
-  Opcodes[0x09] = &opcode_0x09;
-  Opcodes[0x0A] = &opcode_0x0a;
-  Opcodes[0x0B] = &opcode_0x0b;
-  Opcodes[0x0C] = &opcode_0x0c;
-  Opcodes[0x0D] = &opcode_0x0d;
-  Opcodes[0x0E] = &loadcd8;
-  Opcodes[0x0F] = &opcode_0x0f;
-
-  Opcodes[0x10] = &opcode_0x10;
-  Opcodes[0x11] = &opcode_0x11;
-  Opcodes[0x12] = &opcode_0x12;
-  Opcodes[0x13] = &opcode_0x13;
-  Opcodes[0x14] = &opcode_0x14;
-  Opcodes[0x15] = &opcode_0x15;
-  Opcodes[0x16] = &opcode_0x16;
-  Opcodes[0x17] = &opcode_0x17;
-  Opcodes[0x18] = &opcode_0x18;
-  Opcodes[0x19] = &opcode_0x19;
-  Opcodes[0x1A] = &opcode_0x1a;
-  Opcodes[0x1B] = &opcode_0x1b;
-  Opcodes[0x1C] = &opcode_0x1c;
-  Opcodes[0x1D] = &opcode_0x1d;
-  Opcodes[0x1E] = &loaded8;
-  Opcodes[0x1F] = &opcode_0x1f;
-
-  Opcodes[0x20] = &opcode_0x20;
-  Opcodes[0x21] = &opcode_0x21;
-  Opcodes[0x22] = &loadhlpa;
-  Opcodes[0x23] = &opcode_0x23;
-  Opcodes[0x24] = &opcode_0x24;
-  Opcodes[0x25] = &opcode_0x25;
-  Opcodes[0x26] = &opcode_0x26;
-  Opcodes[0x27] = &opcode_0x27;
-  Opcodes[0x28] = &opcode_0x28;
-  Opcodes[0x29] = &opcode_0x29;
-  Opcodes[0x2A] = &opcode_0x2a;
-  Opcodes[0x2B] = &opcode_0x2b;
-  Opcodes[0x2C] = &opcode_0x2c;
-  Opcodes[0x2D] = &opcode_0x2d;
-  Opcodes[0x2E] = &loadld8;
-  Opcodes[0x2F] = &opcode_0x2f;
-
-  Opcodes[0x30] = &opcode_0x30;
-  Opcodes[0x31] = &opcode_0x31;
-  Opcodes[0x32] = &loadhlma;
-  Opcodes[0x33] = &opcode_0x33;
-  Opcodes[0x34] = &opcode_0x34;
-  Opcodes[0x35] = &opcode_0x35;
-  Opcodes[0x36] = &opcode_0x36;
-  Opcodes[0x37] = &opcode_0x37;
-  Opcodes[0x38] = &opcode_0x38;
-  Opcodes[0x39] = &opcode_0x39;
-  Opcodes[0x3A] = &opcode_0x3a;
-  Opcodes[0x3B] = &opcode_0x3b;
-  Opcodes[0x3C] = &opcode_0x3c;
-  Opcodes[0x3D] = &opcode_0x3d;
-  Opcodes[0x3E] = &loadad8;
-  Opcodes[0x3F] = &opcode_0x3f;
-
-  Opcodes[0x40] = &loadbb;
-  Opcodes[0x41] = &loadbc;
-  Opcodes[0x42] = &loadbd;
-  Opcodes[0x43] = &loadbe;
-  Opcodes[0x44] = &loadbh;
-  Opcodes[0x45] = &loadbl;
-  Opcodes[0x46] = &opcode_0x46;
-  Opcodes[0x47] = &loadba;
-  Opcodes[0x48] = &loadcb;
-  Opcodes[0x49] = &loadcc;
-  Opcodes[0x4A] = &loadcd;
-  Opcodes[0x4B] = &loadce;
-  Opcodes[0x4C] = &loadch;
-  Opcodes[0x4D] = &loadcl;
-  Opcodes[0x4E] = &opcode_0x4e;
-  Opcodes[0x4F] = &loadca;
-
-  Opcodes[0x50] = &loaddb;
-  Opcodes[0x51] = &loaddc;
-  Opcodes[0x52] = &loaddd;
-  Opcodes[0x53] = &loadde;
-  Opcodes[0x54] = &loaddh;
-  Opcodes[0x55] = &loaddl;
-  Opcodes[0x56] = &opcode_0x56;
-  Opcodes[0x57] = &loadda;
-  Opcodes[0x58] = &loadeb;
-  Opcodes[0x59] = &loadec;
-  Opcodes[0x5A] = &loaded;
-  Opcodes[0x5B] = &loadee;
-  Opcodes[0x5C] = &loadeh;
-  Opcodes[0x5D] = &loadel;
-  Opcodes[0x5E] = &opcode_0x5e;
-  Opcodes[0x5F] = &loadea;
-
-  Opcodes[0x60] = &loadhb;
-  Opcodes[0x61] = &loadhc;
-  Opcodes[0x62] = &loadhd;
-  Opcodes[0x63] = &loadhe;
-  Opcodes[0x64] = &loadhh;
-  Opcodes[0x65] = &loadhl;
-  Opcodes[0x66] = &opcode_0x66;
-  Opcodes[0x67] = &loadha;
-  Opcodes[0x68] = &loadlb;
-  Opcodes[0x69] = &loadlc;
-  Opcodes[0x6A] = &loadld;
-  Opcodes[0x6B] = &loadle;
-  Opcodes[0x6C] = &loadlh;
-  Opcodes[0x6D] = &loadll;
-  Opcodes[0x6E] = &opcode_0x6e;
-  Opcodes[0x6F] = &loadla;
-
-  Opcodes[0x70] = &opcode_0x70;
-  Opcodes[0x71] = &opcode_0x71;
-  Opcodes[0x72] = &opcode_0x72;
-  Opcodes[0x73] = &opcode_0x73;
-  Opcodes[0x74] = &opcode_0x74;
-  Opcodes[0x75] = &opcode_0x75;
-  Opcodes[0x76] = &opcode_0x76;
-  Opcodes[0x77] = &opcode_0x77;
-  Opcodes[0x78] = &loadab;
-  Opcodes[0x79] = &loadac;
-  Opcodes[0x7A] = &loadad;
-  Opcodes[0x7B] = &loadae;
-  Opcodes[0x7C] = &loadah;
-  Opcodes[0x7D] = &loadal;
-  Opcodes[0x7E] = &opcode_0x7e;
-  Opcodes[0x7F] = &loadaa;
-
-  Opcodes[0x80] = &opcode_0x80;
-  Opcodes[0x81] = &opcode_0x81;
-  Opcodes[0x82] = &opcode_0x82;
-  Opcodes[0x83] = &opcode_0x83;
-  Opcodes[0x84] = &opcode_0x84;
-  Opcodes[0x85] = &opcode_0x85;
-  Opcodes[0x86] = &opcode_0x86;
-  Opcodes[0x87] = &opcode_0x87;
-  Opcodes[0x88] = &opcode_0x88;
-  Opcodes[0x89] = &opcode_0x89;
-  Opcodes[0x8a] = &opcode_0x8a;
-  Opcodes[0x8b] = &opcode_0x8b;
-  Opcodes[0x8c] = &opcode_0x8c;
-  Opcodes[0x8d] = &opcode_0x8d;
-  Opcodes[0x8e] = &opcode_0x8e;
-  Opcodes[0x8f] = &opcode_0x8f;
-
-  Opcodes[0x90] = &opcode_0x90;
-  Opcodes[0x91] = &opcode_0x91;
-  Opcodes[0x92] = &opcode_0x92;
-  Opcodes[0x93] = &opcode_0x93;
-  Opcodes[0x94] = &opcode_0x94;
-  Opcodes[0x95] = &opcode_0x95;
-  Opcodes[0x96] = &opcode_0x96;
-  Opcodes[0x97] = &opcode_0x97;
-  Opcodes[0x98] = &opcode_0x98;
-  Opcodes[0x99] = &opcode_0x99;
-  Opcodes[0x9a] = &opcode_0x9a;
-  Opcodes[0x9b] = &opcode_0x9b;
-  Opcodes[0x9c] = &opcode_0x9c;
-  Opcodes[0x9d] = &opcode_0x9d;
-  Opcodes[0x9e] = &opcode_0x9e;
-  Opcodes[0x9f] = &opcode_0x9f;
-
-  Opcodes[0xA0] = &opcode_0xa0;
-  Opcodes[0xA1] = &opcode_0xa1;
-  Opcodes[0xA2] = &opcode_0xa2;
-  Opcodes[0xA3] = &opcode_0xa3;
-  Opcodes[0xA4] = &opcode_0xa4;
-  Opcodes[0xA5] = &opcode_0xa5;
-  Opcodes[0xA6] = &opcode_0xa6;
-  Opcodes[0xA7] = &opcode_0xa7;
-  Opcodes[0xA8] = &opcode_0xa8;
-  Opcodes[0xA9] = &opcode_0xa9;
-  Opcodes[0xAA] = &opcode_0xaa;
-  Opcodes[0xAB] = &opcode_0xab;
-  Opcodes[0xAC] = &opcode_0xac;
-  Opcodes[0xAD] = &opcode_0xad;
-  Opcodes[0xAE] = &opcode_0xae;
-  Opcodes[0xAF] = &opcode_0xaf;
-
-  Opcodes[0xB0] = &opcode_0xb0;
-  Opcodes[0xB1] = &opcode_0xb1;
-  Opcodes[0xB2] = &opcode_0xb2;
-  Opcodes[0xB3] = &opcode_0xb3;
-  Opcodes[0xB4] = &opcode_0xb4;
-  Opcodes[0xB5] = &opcode_0xb5;
-  Opcodes[0xB6] = &opcode_0xb6;
-  Opcodes[0xB7] = &opcode_0xb7;
-  Opcodes[0xB8] = &opcode_0xb8;
-  Opcodes[0xB9] = &opcode_0xb9;
-  Opcodes[0xBA] = &opcode_0xba;
-  Opcodes[0xBB] = &opcode_0xbb;
-  Opcodes[0xBC] = &opcode_0xbc;
-  Opcodes[0xBD] = &opcode_0xbd;
-  Opcodes[0xBE] = &opcode_0xbe;
-  Opcodes[0xBF] = &opcode_0xbf;
-
-  Opcodes[0xC0] = &opcode_0xc0;
-  Opcodes[0xC1] = &opcode_0xc1;
-  Opcodes[0xC2] = &opcode_0xc2;
-  Opcodes[0xC3] = &opcode_0xc3;
-  Opcodes[0xC4] = &opcode_0xc4;
-  Opcodes[0xC5] = &opcode_0xc5;
-  Opcodes[0xC6] = &opcode_0xc6;
-  Opcodes[0xC7] = &opcode_0xc7;
-  Opcodes[0xC8] = &opcode_0xc8;
-  Opcodes[0xC9] = &opcode_0xc9;
-  Opcodes[0xCA] = &opcode_0xca;
-  Opcodes[0xCB] = &prefixcb;
-  Opcodes[0xCC] = &opcode_0xcc;
-  Opcodes[0xCD] = &opcode_0xcd;
-  Opcodes[0xCE] = &opcode_0xce;
-  Opcodes[0xCF] = &opcode_0xcf;
-
-  Opcodes[0xD0] = &opcode_0xd0;
-  Opcodes[0xD1] = &opcode_0xd1;
-  Opcodes[0xD2] = &opcode_0xd2;
-  Opcodes[0xD4] = &opcode_0xd4;
-  Opcodes[0xD5] = &opcode_0xd5;
-  Opcodes[0xD6] = &opcode_0xd6;
-  Opcodes[0xD7] = &opcode_0xd7;
-  Opcodes[0xD8] = &opcode_0xd8;
-  Opcodes[0xD9] = &opcode_0xd9;
-  Opcodes[0xDA] = &opcode_0xda;
-  Opcodes[0xDC] = &opcode_0xdc;
-  Opcodes[0xDE] = &opcode_0xde;
-  Opcodes[0xDF] = &opcode_0xdf;
-
-  Opcodes[0xE0] = &opcode_0xe0;
-  Opcodes[0xE1] = &opcode_0xe1;
-  Opcodes[0xE2] = &opcode_0xe2;
-  Opcodes[0xE5] = &opcode_0xe5;
-  Opcodes[0xE6] = &opcode_0xe6;
-  Opcodes[0xE7] = &opcode_0xe7;
-  Opcodes[0xE8] = &opcode_0xe8;
-  Opcodes[0xE9] = &opcode_0xe9;
-  Opcodes[0xEA] = &opcode_0xea;
-  Opcodes[0xEE] = &opcode_0xee;
-  Opcodes[0xEF] = &opcode_0xef;
-
-  Opcodes[0xF0] = &opcode_0xf0;
-  Opcodes[0xF1] = &opcode_0xf1;
-  Opcodes[0xF2] = &opcode_0xf2;
-  Opcodes[0xF3] = &opcode_0xf3;
-  Opcodes[0xF5] = &opcode_0xf5;
-  Opcodes[0xF6] = &opcode_0xf6;
-  Opcodes[0xF7] = &opcode_0xf7;
-  Opcodes[0xF8] = &opcode_0xf8;
-  Opcodes[0xF9] = &opcode_0xf9;
-  Opcodes[0xFA] = &opcode_0xfa;
-  Opcodes[0xFB] = &opcode_0xfb;
-  Opcodes[0xFE] = &opcode_0xfe;
-  Opcodes[0xFF] = &opcode_0xff;
-}
-
-void load_prefixcb(void)
-{
-  PrefixCB[0x00] = &prefix_0x00;
-  PrefixCB[0x01] = &prefix_0x01;
-  PrefixCB[0x02] = &prefix_0x02;
-  PrefixCB[0x03] = &prefix_0x03;
-  PrefixCB[0x04] = &prefix_0x04;
-  PrefixCB[0x05] = &prefix_0x05;
-  PrefixCB[0x06] = &prefix_0x06;
-  PrefixCB[0x07] = &prefix_0x07;
-  PrefixCB[0x08] = &prefix_0x08;
-  PrefixCB[0x09] = &prefix_0x09;
-  PrefixCB[0x0a] = &prefix_0x0a;
-  PrefixCB[0x0b] = &prefix_0x0b;
-  PrefixCB[0x0c] = &prefix_0x0c;
-  PrefixCB[0x0d] = &prefix_0x0d;
-  PrefixCB[0x0e] = &prefix_0x0e;
-  PrefixCB[0x0f] = &prefix_0x0f;
-
-  PrefixCB[0x10] = &prefix_0x10;
-  PrefixCB[0x11] = &prefix_0x11;
-  PrefixCB[0x12] = &prefix_0x12;
-  PrefixCB[0x13] = &prefix_0x13;
-  PrefixCB[0x14] = &prefix_0x14;
-  PrefixCB[0x15] = &prefix_0x15;
-  PrefixCB[0x16] = &prefix_0x16;
-  PrefixCB[0x17] = &prefix_0x17;
-  PrefixCB[0x18] = &prefix_0x18;
-  PrefixCB[0x19] = &prefix_0x19;
-  PrefixCB[0x1a] = &prefix_0x1a;
-  PrefixCB[0x1b] = &prefix_0x1b;
-  PrefixCB[0x1c] = &prefix_0x1c;
-  PrefixCB[0x1d] = &prefix_0x1d;
-  PrefixCB[0x1e] = &prefix_0x1e;
-  PrefixCB[0x1f] = &prefix_0x1f;
-
-  PrefixCB[0x20] = &prefix_0x20;
-  PrefixCB[0x21] = &prefix_0x21;
-  PrefixCB[0x22] = &prefix_0x22;
-  PrefixCB[0x23] = &prefix_0x23;
-  PrefixCB[0x24] = &prefix_0x24;
-  PrefixCB[0x25] = &prefix_0x25;
-  PrefixCB[0x26] = &prefix_0x26;
-  PrefixCB[0x27] = &prefix_0x27;
-  PrefixCB[0x28] = &prefix_0x28;
-  PrefixCB[0x29] = &prefix_0x29;
-  PrefixCB[0x2a] = &prefix_0x2a;
-  PrefixCB[0x2b] = &prefix_0x2b;
-  PrefixCB[0x2c] = &prefix_0x2c;
-  PrefixCB[0x2d] = &prefix_0x2d;
-  PrefixCB[0x2e] = &prefix_0x2e;
-  PrefixCB[0x2f] = &prefix_0x2f;
-
-  PrefixCB[0x30] = &prefix_0x30;
-  PrefixCB[0x31] = &prefix_0x31;
-  PrefixCB[0x32] = &prefix_0x32;
-  PrefixCB[0x33] = &prefix_0x33;
-  PrefixCB[0x34] = &prefix_0x34;
-  PrefixCB[0x35] = &prefix_0x35;
-  PrefixCB[0x36] = &prefix_0x36;
-  PrefixCB[0x37] = &prefix_0x37;
-  PrefixCB[0x38] = &prefix_0x38;
-  PrefixCB[0x39] = &prefix_0x39;
-  PrefixCB[0x3a] = &prefix_0x3a;
-  PrefixCB[0x3b] = &prefix_0x3b;
-  PrefixCB[0x3c] = &prefix_0x3c;
-  PrefixCB[0x3d] = &prefix_0x3d;
-  PrefixCB[0x3e] = &prefix_0x3e;
-  PrefixCB[0x3f] = &prefix_0x3f;
-
-  PrefixCB[0x40] = &prefix_0x40;
-  PrefixCB[0x41] = &prefix_0x41;
-  PrefixCB[0x42] = &prefix_0x42;
-  PrefixCB[0x43] = &prefix_0x43;
-  PrefixCB[0x44] = &prefix_0x44;
-  PrefixCB[0x45] = &prefix_0x45;
-  PrefixCB[0x46] = &prefix_0x46;
-  PrefixCB[0x47] = &prefix_0x47;
-  PrefixCB[0x48] = &prefix_0x48;
-  PrefixCB[0x49] = &prefix_0x49;
-  PrefixCB[0x4A] = &prefix_0x4a;
-  PrefixCB[0x4B] = &prefix_0x4b;
-  PrefixCB[0x4C] = &prefix_0x4c;
-  PrefixCB[0x4D] = &prefix_0x4d;
-  PrefixCB[0x4E] = &prefix_0x4e;
-  PrefixCB[0x4F] = &prefix_0x4f;
-
-  PrefixCB[0x50] = &prefix_0x50;
-  PrefixCB[0x51] = &prefix_0x51;
-  PrefixCB[0x52] = &prefix_0x52;
-  PrefixCB[0x53] = &prefix_0x53;
-  PrefixCB[0x54] = &prefix_0x54;
-  PrefixCB[0x55] = &prefix_0x55;
-  PrefixCB[0x56] = &prefix_0x56;
-  PrefixCB[0x57] = &prefix_0x57;
-  PrefixCB[0x58] = &prefix_0x58;
-  PrefixCB[0x59] = &prefix_0x59;
-  PrefixCB[0x5A] = &prefix_0x5a;
-  PrefixCB[0x5B] = &prefix_0x5b;
-  PrefixCB[0x5C] = &prefix_0x5c;
-  PrefixCB[0x5D] = &prefix_0x5d;
-  PrefixCB[0x5E] = &prefix_0x5e;
-  PrefixCB[0x5F] = &prefix_0x5f;
-
-  PrefixCB[0x60] = &prefix_0x60;
-  PrefixCB[0x61] = &prefix_0x61;
-  PrefixCB[0x62] = &prefix_0x62;
-  PrefixCB[0x63] = &prefix_0x63;
-  PrefixCB[0x64] = &prefix_0x64;
-  PrefixCB[0x65] = &prefix_0x65;
-  PrefixCB[0x66] = &prefix_0x66;
-  PrefixCB[0x67] = &prefix_0x67;
-  PrefixCB[0x68] = &prefix_0x68;
-  PrefixCB[0x69] = &prefix_0x69;
-  PrefixCB[0x6A] = &prefix_0x6a;
-  PrefixCB[0x6B] = &prefix_0x6b;
-  PrefixCB[0x6C] = &prefix_0x6c;
-  PrefixCB[0x6D] = &prefix_0x6d;
-  PrefixCB[0x6E] = &prefix_0x6e;
-  PrefixCB[0x6F] = &prefix_0x6f;
-
-  PrefixCB[0x70] = &prefix_0x70;
-  PrefixCB[0x71] = &prefix_0x71;
-  PrefixCB[0x72] = &prefix_0x72;
-  PrefixCB[0x73] = &prefix_0x73;
-  PrefixCB[0x74] = &prefix_0x74;
-  PrefixCB[0x75] = &prefix_0x75;
-  PrefixCB[0x76] = &prefix_0x76;
-  PrefixCB[0x77] = &prefix_0x77;
-  PrefixCB[0x78] = &prefix_0x78;
-  PrefixCB[0x79] = &prefix_0x79;
-  PrefixCB[0x7A] = &prefix_0x7a;
-  PrefixCB[0x7B] = &prefix_0x7b;
-  PrefixCB[0x7C] = &prefix_0x7c;
-  PrefixCB[0x7D] = &prefix_0x7d;
-  PrefixCB[0x7E] = &prefix_0x7e;
-  PrefixCB[0x7F] = &prefix_0x7f;
-
-  PrefixCB[0x80] = &prefix_0x80;
-  PrefixCB[0x81] = &prefix_0x81;
-  PrefixCB[0x82] = &prefix_0x82;
-  PrefixCB[0x83] = &prefix_0x83;
-  PrefixCB[0x84] = &prefix_0x84;
-  PrefixCB[0x85] = &prefix_0x85;
-  PrefixCB[0x86] = &prefix_0x86;
-  PrefixCB[0x87] = &prefix_0x87;
-  PrefixCB[0x88] = &prefix_0x88;
-  PrefixCB[0x89] = &prefix_0x89;
-  PrefixCB[0x8A] = &prefix_0x8a;
-  PrefixCB[0x8B] = &prefix_0x8b;
-  PrefixCB[0x8C] = &prefix_0x8c;
-  PrefixCB[0x8D] = &prefix_0x8d;
-  PrefixCB[0x8E] = &prefix_0x8e;
-  PrefixCB[0x8F] = &prefix_0x8f;
-
-  PrefixCB[0x90] = &prefix_0x90;
-  PrefixCB[0x91] = &prefix_0x91;
-  PrefixCB[0x92] = &prefix_0x92;
-  PrefixCB[0x93] = &prefix_0x93;
-  PrefixCB[0x94] = &prefix_0x94;
-  PrefixCB[0x95] = &prefix_0x95;
-  PrefixCB[0x96] = &prefix_0x96;
-  PrefixCB[0x97] = &prefix_0x97;
-  PrefixCB[0x98] = &prefix_0x98;
-  PrefixCB[0x99] = &prefix_0x99;
-  PrefixCB[0x9A] = &prefix_0x9a;
-  PrefixCB[0x9B] = &prefix_0x9b;
-  PrefixCB[0x9C] = &prefix_0x9c;
-  PrefixCB[0x9D] = &prefix_0x9d;
-  PrefixCB[0x9E] = &prefix_0x9e;
-  PrefixCB[0x9F] = &prefix_0x9f;
-
-  PrefixCB[0xa0] = &prefix_0xa0;
-  PrefixCB[0xa1] = &prefix_0xa1;
-  PrefixCB[0xa2] = &prefix_0xa2;
-  PrefixCB[0xa3] = &prefix_0xa3;
-  PrefixCB[0xa4] = &prefix_0xa4;
-  PrefixCB[0xa5] = &prefix_0xa5;
-  PrefixCB[0xa6] = &prefix_0xa6;
-  PrefixCB[0xa7] = &prefix_0xa7;
-  PrefixCB[0xa8] = &prefix_0xa8;
-  PrefixCB[0xa9] = &prefix_0xa9;
-  PrefixCB[0xaA] = &prefix_0xaa;
-  PrefixCB[0xaB] = &prefix_0xab;
-  PrefixCB[0xaC] = &prefix_0xac;
-  PrefixCB[0xaD] = &prefix_0xad;
-  PrefixCB[0xaE] = &prefix_0xae;
-  PrefixCB[0xaF] = &prefix_0xaf;
-
-  PrefixCB[0xb0] = &prefix_0xb0;
-  PrefixCB[0xb1] = &prefix_0xb1;
-  PrefixCB[0xb2] = &prefix_0xb2;
-  PrefixCB[0xb3] = &prefix_0xb3;
-  PrefixCB[0xb4] = &prefix_0xb4;
-  PrefixCB[0xb5] = &prefix_0xb5;
-  PrefixCB[0xb6] = &prefix_0xb6;
-  PrefixCB[0xb7] = &prefix_0xb7;
-  PrefixCB[0xb8] = &prefix_0xb8;
-  PrefixCB[0xb9] = &prefix_0xb9;
-  PrefixCB[0xbA] = &prefix_0xba;
-  PrefixCB[0xbB] = &prefix_0xbb;
-  PrefixCB[0xbC] = &prefix_0xbc;
-  PrefixCB[0xbD] = &prefix_0xbd;
-  PrefixCB[0xbE] = &prefix_0xbe;
-  PrefixCB[0xbF] = &prefix_0xbf;
-
-  PrefixCB[0xc0] = &prefix_0xc0;
-  PrefixCB[0xc1] = &prefix_0xc1;
-  PrefixCB[0xc2] = &prefix_0xc2;
-  PrefixCB[0xc3] = &prefix_0xc3;
-  PrefixCB[0xc4] = &prefix_0xc4;
-  PrefixCB[0xc5] = &prefix_0xc5;
-  PrefixCB[0xc6] = &prefix_0xc6;
-  PrefixCB[0xc7] = &prefix_0xc7;
-  PrefixCB[0xc8] = &prefix_0xc8;
-  PrefixCB[0xc9] = &prefix_0xc9;
-  PrefixCB[0xcA] = &prefix_0xca;
-  PrefixCB[0xcB] = &prefix_0xcb;
-  PrefixCB[0xcC] = &prefix_0xcc;
-  PrefixCB[0xcD] = &prefix_0xcd;
-  PrefixCB[0xcE] = &prefix_0xce;
-  PrefixCB[0xcF] = &prefix_0xcf;
-
-  PrefixCB[0xd0] = &prefix_0xd0;
-  PrefixCB[0xd1] = &prefix_0xd1;
-  PrefixCB[0xd2] = &prefix_0xd2;
-  PrefixCB[0xd3] = &prefix_0xd3;
-  PrefixCB[0xd4] = &prefix_0xd4;
-  PrefixCB[0xd5] = &prefix_0xd5;
-  PrefixCB[0xd6] = &prefix_0xd6;
-  PrefixCB[0xd7] = &prefix_0xd7;
-  PrefixCB[0xd8] = &prefix_0xd8;
-  PrefixCB[0xd9] = &prefix_0xd9;
-  PrefixCB[0xdA] = &prefix_0xda;
-  PrefixCB[0xdB] = &prefix_0xdb;
-  PrefixCB[0xdC] = &prefix_0xdc;
-  PrefixCB[0xdD] = &prefix_0xdd;
-  PrefixCB[0xdE] = &prefix_0xde;
-  PrefixCB[0xdF] = &prefix_0xdf;
-
-  PrefixCB[0xe0] = &prefix_0xe0;
-  PrefixCB[0xe1] = &prefix_0xe1;
-  PrefixCB[0xe2] = &prefix_0xe2;
-  PrefixCB[0xe3] = &prefix_0xe3;
-  PrefixCB[0xe4] = &prefix_0xe4;
-  PrefixCB[0xe5] = &prefix_0xe5;
-  PrefixCB[0xe6] = &prefix_0xe6;
-  PrefixCB[0xe7] = &prefix_0xe7;
-  PrefixCB[0xe8] = &prefix_0xe8;
-  PrefixCB[0xe9] = &prefix_0xe9;
-  PrefixCB[0xeA] = &prefix_0xea;
-  PrefixCB[0xeB] = &prefix_0xeb;
-  PrefixCB[0xeC] = &prefix_0xec;
-  PrefixCB[0xeD] = &prefix_0xed;
-  PrefixCB[0xeE] = &prefix_0xee;
-  PrefixCB[0xeF] = &prefix_0xef;
-
-  PrefixCB[0xf0] = &prefix_0xf0;
-  PrefixCB[0xf1] = &prefix_0xf1;
-  PrefixCB[0xf2] = &prefix_0xf2;
-  PrefixCB[0xf3] = &prefix_0xf3;
-  PrefixCB[0xf4] = &prefix_0xf4;
-  PrefixCB[0xf5] = &prefix_0xf5;
-  PrefixCB[0xf6] = &prefix_0xf6;
-  PrefixCB[0xf7] = &prefix_0xf7;
-  PrefixCB[0xf8] = &prefix_0xf8;
-  PrefixCB[0xf9] = &prefix_0xf9;
-  PrefixCB[0xfA] = &prefix_0xfa;
-  PrefixCB[0xfB] = &prefix_0xfb;
-  PrefixCB[0xfC] = &prefix_0xfc;
-  PrefixCB[0xfD] = &prefix_0xfd;
-  PrefixCB[0xfE] = &prefix_0xfe;
-  PrefixCB[0xfF] = &prefix_0xff;
-}
-
-void update_timers(void)
-{
-  my_clock.divider += my_clock.m;
-
-  if (test_bit(MMU.memory[0xFF07], 2))
+void prefix_0xc0(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 0); }
+void prefix_0xc1(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 0); }
+void prefix_0xc2(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 0); }
+void prefix_0xc3(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 0); }
+void prefix_0xc4(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 0); }
+void prefix_0xc5(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 0); }
+void prefix_0xc6(GbContext *gb) { set_op(gb, hl_byte(gb), 0); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xc7(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 0); }
+
+void prefix_0xc8(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 1); }
+void prefix_0xc9(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 1); }
+void prefix_0xca(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 1); }
+void prefix_0xcb(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 1); }
+void prefix_0xcc(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 1); }
+void prefix_0xcd(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 1); }
+void prefix_0xce(GbContext *gb) { set_op(gb, hl_byte(gb), 1); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xcf(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 1); }
+
+void prefix_0xd0(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 2); }
+void prefix_0xd1(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 2); }
+void prefix_0xd2(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 2); }
+void prefix_0xd3(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 2); }
+void prefix_0xd4(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 2); }
+void prefix_0xd5(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 2); }
+void prefix_0xd6(GbContext *gb) { set_op(gb, hl_byte(gb), 2); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xd7(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 2); }
+
+void prefix_0xd8(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 3); }
+void prefix_0xd9(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 3); }
+void prefix_0xda(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 3); }
+void prefix_0xdb(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 3); }
+void prefix_0xdc(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 3); }
+void prefix_0xdd(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 3); }
+void prefix_0xde(GbContext *gb) { set_op(gb, hl_byte(gb), 3); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xdf(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 3); }
+
+void prefix_0xe0(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 4); }
+void prefix_0xe1(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 4); }
+void prefix_0xe2(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 4); }
+void prefix_0xe3(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 4); }
+void prefix_0xe4(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 4); }
+void prefix_0xe5(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 4); }
+void prefix_0xe6(GbContext *gb) { set_op(gb, hl_byte(gb), 4); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xe7(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 4); }
+
+void prefix_0xe8(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 5); }
+void prefix_0xe9(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 5); }
+void prefix_0xea(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 5); }
+void prefix_0xeb(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 5); }
+void prefix_0xec(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 5); }
+void prefix_0xed(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 5); }
+void prefix_0xee(GbContext *gb) { set_op(gb, hl_byte(gb), 5); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xef(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 5); }
+
+void prefix_0xf0(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 6); }
+void prefix_0xf1(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 6); }
+void prefix_0xf2(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 6); }
+void prefix_0xf3(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 6); }
+void prefix_0xf4(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 6); }
+void prefix_0xf5(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 6); }
+void prefix_0xf6(GbContext *gb) { set_op(gb, hl_byte(gb), 6); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xf7(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 6); }
+
+void prefix_0xf8(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.high, 7); }
+void prefix_0xf9(GbContext *gb) { set_op(gb, &gb->r.BC.bytes.low, 7); }
+void prefix_0xfa(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.high, 7); }
+void prefix_0xfb(GbContext *gb) { set_op(gb, &gb->r.DE.bytes.low, 7); }
+void prefix_0xfc(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.high, 7); }
+void prefix_0xfd(GbContext *gb) { set_op(gb, &gb->r.HL.bytes.low, 7); }
+void prefix_0xfe(GbContext *gb) { set_op(gb, hl_byte(gb), 7); gb->clock.m = 2; gb->clock.t = 16; }
+void prefix_0xff(GbContext *gb) { set_op(gb, &gb->r.AF.bytes.high, 7); }
+
+static void (*const Opcodes[0x100]) (GbContext *gb) =
+{
+  [0x00] = &opcode_0x00,
+  [0x01] = &opcode_0x01,
+  [0x02] = &opcode_0x02,
+  [0x03] = &opcode_0x03,
+  [0x04] = &opcode_0x04,
+  [0x05] = &opcode_0x05,
+  [0x06] = &opcode_0x06,
+  [0x07] = &opcode_0x07,
+  [0x08] = &opcode_0x08,
+  [0x09] = &opcode_0x09,
+  [0x0A] = &opcode_0x0a,
+  [0x0B] = &opcode_0x0b,
+  [0x0C] = &opcode_0x0c,
+  [0x0D] = &opcode_0x0d,
+  [0x0E] = &loadcd8,
+  [0x0F] = &opcode_0x0f,
+
+  [0x10] = &opcode_0x10,
+  [0x11] = &opcode_0x11,
+  [0x12] = &opcode_0x12,
+  [0x13] = &opcode_0x13,
+  [0x14] = &opcode_0x14,
+  [0x15] = &opcode_0x15,
+  [0x16] = &opcode_0x16,
+  [0x17] = &opcode_0x17,
+  [0x18] = &opcode_0x18,
+  [0x19] = &opcode_0x19,
+  [0x1A] = &opcode_0x1a,
+  [0x1B] = &opcode_0x1b,
+  [0x1C] = &opcode_0x1c,
+  [0x1D] = &opcode_0x1d,
+  [0x1E] = &loaded8,
+  [0x1F] = &opcode_0x1f,
+
+  [0x20] = &opcode_0x20,
+  [0x21] = &opcode_0x21,
+  [0x22] = &loadhlpa,
+  [0x23] = &opcode_0x23,
+  [0x24] = &opcode_0x24,
+  [0x25] = &opcode_0x25,
+  [0x26] = &opcode_0x26,
+  [0x27] = &opcode_0x27,
+  [0x28] = &opcode_0x28,
+  [0x29] = &opcode_0x29,
+  [0x2A] = &opcode_0x2a,
+  [0x2B] = &opcode_0x2b,
+  [0x2C] = &opcode_0x2c,
+  [0x2D] = &opcode_0x2d,
+  [0x2E] = &loadld8,
+  [0x2F] = &opcode_0x2f,
+
+  [0x30] = &opcode_0x30,
+  [0x31] = &opcode_0x31,
+  [0x32] = &loadhlma,
+  [0x33] = &opcode_0x33,
+  [0x34] = &opcode_0x34,
+  [0x35] = &opcode_0x35,
+  [0x36] = &opcode_0x36,
+  [0x37] = &opcode_0x37,
+  [0x38] = &opcode_0x38,
+  [0x39] = &opcode_0x39,
+  [0x3A] = &opcode_0x3a,
+  [0x3B] = &opcode_0x3b,
+  [0x3C] = &opcode_0x3c,
+  [0x3D] = &opcode_0x3d,
+  [0x3E] = &loadad8,
+  [0x3F] = &opcode_0x3f,
+
+  [0x40] = &loadbb,
+  [0x41] = &loadbc,
+  [0x42] = &loadbd,
+  [0x43] = &loadbe,
+  [0x44] = &loadbh,
+  [0x45] = &loadbl,
+  [0x46] = &opcode_0x46,
+  [0x47] = &loadba,
+  [0x48] = &loadcb,
+  [0x49] = &loadcc,
+  [0x4A] = &loadcd,
+  [0x4B] = &loadce,
+  [0x4C] = &loadch,
+  [0x4D] = &loadcl,
+  [0x4E] = &opcode_0x4e,
+  [0x4F] = &loadca,
+
+  [0x50] = &loaddb,
+  [0x51] = &loaddc,
+  [0x52] = &loaddd,
+  [0x53] = &loadde,
+  [0x54] = &loaddh,
+  [0x55] = &loaddl,
+  [0x56] = &opcode_0x56,
+  [0x57] = &loadda,
+  [0x58] = &loadeb,
+  [0x59] = &loadec,
+  [0x5A] = &loaded,
+  [0x5B] = &loadee,
+  [0x5C] = &loadeh,
+  [0x5D] = &loadel,
+  [0x5E] = &opcode_0x5e,
+  [0x5F] = &loadea,
+
+  [0x60] = &loadhb,
+  [0x61] = &loadhc,
+  [0x62] = &loadhd,
+  [0x63] = &loadhe,
+  [0x64] = &loadhh,
+  [0x65] = &loadhl,
+  [0x66] = &opcode_0x66,
+  [0x67] = &loadha,
+  [0x68] = &loadlb,
+  [0x69] = &loadlc,
+  [0x6A] = &loadld,
+  [0x6B] = &loadle,
+  [0x6C] = &loadlh,
+  [0x6D] = &loadll,
+  [0x6E] = &opcode_0x6e,
+  [0x6F] = &loadla,
+
+  [0x70] = &opcode_0x70,
+  [0x71] = &opcode_0x71,
+  [0x72] = &opcode_0x72,
+  [0x73] = &opcode_0x73,
+  [0x74] = &opcode_0x74,
+  [0x75] = &opcode_0x75,
+  [0x76] = &opcode_0x76,
+  [0x77] = &opcode_0x77,
+  [0x78] = &loadab,
+  [0x79] = &loadac,
+  [0x7A] = &loadad,
+  [0x7B] = &loadae,
+  [0x7C] = &loadah,
+  [0x7D] = &loadal,
+  [0x7E] = &opcode_0x7e,
+  [0x7F] = &loadaa,
+
+  [0x80] = &opcode_0x80,
+  [0x81] = &opcode_0x81,
+  [0x82] = &opcode_0x82,
+  [0x83] = &opcode_0x83,
+  [0x84] = &opcode_0x84,
+  [0x85] = &opcode_0x85,
+  [0x86] = &opcode_0x86,
+  [0x87] = &opcode_0x87,
+  [0x88] = &opcode_0x88,
+  [0x89] = &opcode_0x89,
+  [0x8A] = &opcode_0x8a,
+  [0x8B] = &opcode_0x8b,
+  [0x8C] = &opcode_0x8c,
+  [0x8D] = &opcode_0x8d,
+  [0x8E] = &opcode_0x8e,
+  [0x8F] = &opcode_0x8f,
+
+  [0x90] = &opcode_0x90,
+  [0x91] = &opcode_0x91,
+  [0x92] = &opcode_0x92,
+  [0x93] = &opcode_0x93,
+  [0x94] = &opcode_0x94,
+  [0x95] = &opcode_0x95,
+  [0x96] = &opcode_0x96,
+  [0x97] = &opcode_0x97,
+  [0x98] = &opcode_0x98,
+  [0x99] = &opcode_0x99,
+  [0x9A] = &opcode_0x9a,
+  [0x9B] = &opcode_0x9b,
+  [0x9C] = &opcode_0x9c,
+  [0x9D] = &opcode_0x9d,
+  [0x9E] = &opcode_0x9e,
+  [0x9F] = &opcode_0x9f,
+
+  [0xA0] = &opcode_0xa0,
+  [0xA1] = &opcode_0xa1,
+  [0xA2] = &opcode_0xa2,
+  [0xA3] = &opcode_0xa3,
+  [0xA4] = &opcode_0xa4,
+  [0xA5] = &opcode_0xa5,
+  [0xA6] = &opcode_0xa6,
+  [0xA7] = &opcode_0xa7,
+  [0xA8] = &opcode_0xa8,
+  [0xA9] = &opcode_0xa9,
+  [0xAA] = &opcode_0xaa,
+  [0xAB] = &opcode_0xab,
+  [0xAC] = &opcode_0xac,
+  [0xAD] = &opcode_0xad,
+  [0xAE] = &opcode_0xae,
+  [0xAF] = &opcode_0xaf,
+
+  [0xB0] = &opcode_0xb0,
+  [0xB1] = &opcode_0xb1,
+  [0xB2] = &opcode_0xb2,
+  [0xB3] = &opcode_0xb3,
+  [0xB4] = &opcode_0xb4,
+  [0xB5] = &opcode_0xb5,
+  [0xB6] = &opcode_0xb6,
+  [0xB7] = &opcode_0xb7,
+  [0xB8] = &opcode_0xb8,
+  [0xB9] = &opcode_0xb9,
+  [0xBA] = &opcode_0xba,
+  [0xBB] = &opcode_0xbb,
+  [0xBC] = &opcode_0xbc,
+  [0xBD] = &opcode_0xbd,
+  [0xBE] = &opcode_0xbe,
+  [0xBF] = &opcode_0xbf,
+
+  [0xC0] = &opcode_0xc0,
+  [0xC1] = &opcode_0xc1,
+  [0xC2] = &opcode_0xc2,
+  [0xC3] = &opcode_0xc3,
+  [0xC4] = &opcode_0xc4,
+  [0xC5] = &opcode_0xc5,
+  [0xC6] = &opcode_0xc6,
+  [0xC7] = &opcode_0xc7,
+  [0xC8] = &opcode_0xc8,
+  [0xC9] = &opcode_0xc9,
+  [0xCA] = &opcode_0xca,
+  [0xCB] = &prefixcb,
+  [0xCC] = &opcode_0xcc,
+  [0xCD] = &opcode_0xcd,
+  [0xCE] = &opcode_0xce,
+  [0xCF] = &opcode_0xcf,
+
+  [0xD0] = &opcode_0xd0,
+  [0xD1] = &opcode_0xd1,
+  [0xD2] = &opcode_0xd2,
+  [0xD4] = &opcode_0xd4,
+  [0xD5] = &opcode_0xd5,
+  [0xD6] = &opcode_0xd6,
+  [0xD7] = &opcode_0xd7,
+  [0xD8] = &opcode_0xd8,
+  [0xD9] = &opcode_0xd9,
+  [0xDA] = &opcode_0xda,
+  [0xDC] = &opcode_0xdc,
+  [0xDE] = &opcode_0xde,
+  [0xDF] = &opcode_0xdf,
+
+  [0xE0] = &opcode_0xe0,
+  [0xE1] = &opcode_0xe1,
+  [0xE2] = &opcode_0xe2,
+  [0xE5] = &opcode_0xe5,
+  [0xE6] = &opcode_0xe6,
+  [0xE7] = &opcode_0xe7,
+  [0xE8] = &opcode_0xe8,
+  [0xE9] = &opcode_0xe9,
+  [0xEA] = &opcode_0xea,
+  [0xEE] = &opcode_0xee,
+  [0xEF] = &opcode_0xef,
+
+  [0xF0] = &opcode_0xf0,
+  [0xF1] = &opcode_0xf1,
+  [0xF2] = &opcode_0xf2,
+  [0xF3] = &opcode_0xf3,
+  [0xF5] = &opcode_0xf5,
+  [0xF6] = &opcode_0xf6,
+  [0xF7] = &opcode_0xf7,
+  [0xF8] = &opcode_0xf8,
+  [0xF9] = &opcode_0xf9,
+  [0xFA] = &opcode_0xfa,
+  [0xFB] = &opcode_0xfb,
+  [0xFE] = &opcode_0xfe,
+  [0xFF] = &opcode_0xff,
+};
+
+static void (*const PrefixCB[0x100]) (GbContext *gb) =
+{
+  [0x00] = &prefix_0x00,
+  [0x01] = &prefix_0x01,
+  [0x02] = &prefix_0x02,
+  [0x03] = &prefix_0x03,
+  [0x04] = &prefix_0x04,
+  [0x05] = &prefix_0x05,
+  [0x06] = &prefix_0x06,
+  [0x07] = &prefix_0x07,
+  [0x08] = &prefix_0x08,
+  [0x09] = &prefix_0x09,
+  [0x0A] = &prefix_0x0a,
+  [0x0B] = &prefix_0x0b,
+  [0x0C] = &prefix_0x0c,
+  [0x0D] = &prefix_0x0d,
+  [0x0E] = &prefix_0x0e,
+  [0x0F] = &prefix_0x0f,
+
+  [0x10] = &prefix_0x10,
+  [0x11] = &prefix_0x11,
+  [0x12] = &prefix_0x12,
+  [0x13] = &prefix_0x13,
+  [0x14] = &prefix_0x14,
+  [0x15] = &prefix_0x15,
+  [0x16] = &prefix_0x16,
+  [0x17] = &prefix_0x17,
+  [0x18] = &prefix_0x18,
+  [0x19] = &prefix_0x19,
+  [0x1A] = &prefix_0x1a,
+  [0x1B] = &prefix_0x1b,
+  [0x1C] = &prefix_0x1c,
+  [0x1D] = &prefix_0x1d,
+  [0x1E] = &prefix_0x1e,
+  [0x1F] = &prefix_0x1f,
+
+  [0x20] = &prefix_0x20,
+  [0x21] = &prefix_0x21,
+  [0x22] = &prefix_0x22,
+  [0x23] = &prefix_0x23,
+  [0x24] = &prefix_0x24,
+  [0x25] = &prefix_0x25,
+  [0x26] = &prefix_0x26,
+  [0x27] = &prefix_0x27,
+  [0x28] = &prefix_0x28,
+  [0x29] = &prefix_0x29,
+  [0x2A] = &prefix_0x2a,
+  [0x2B] = &prefix_0x2b,
+  [0x2C] = &prefix_0x2c,
+  [0x2D] = &prefix_0x2d,
+  [0x2E] = &prefix_0x2e,
+  [0x2F] = &prefix_0x2f,
+
+  [0x30] = &prefix_0x30,
+  [0x31] = &prefix_0x31,
+  [0x32] = &prefix_0x32,
+  [0x33] = &prefix_0x33,
+  [0x34] = &prefix_0x34,
+  [0x35] = &prefix_0x35,
+  [0x36] = &prefix_0x36,
+  [0x37] = &prefix_0x37,
+  [0x38] = &prefix_0x38,
+  [0x39] = &prefix_0x39,
+  [0x3A] = &prefix_0x3a,
+  [0x3B] = &prefix_0x3b,
+  [0x3C] = &prefix_0x3c,
+  [0x3D] = &prefix_0x3d,
+  [0x3E] = &prefix_0x3e,
+  [0x3F] = &prefix_0x3f,
+
+  [0x40] = &prefix_0x40,
+  [0x41] = &prefix_0x41,
+  [0x42] = &prefix_0x42,
+  [0x43] = &prefix_0x43,
+  [0x44] = &prefix_0x44,
+  [0x45] = &prefix_0x45,
+  [0x46] = &prefix_0x46,
+  [0x47] = &prefix_0x47,
+  [0x48] = &prefix_0x48,
+  [0x49] = &prefix_0x49,
+  [0x4A] = &prefix_0x4a,
+  [0x4B] = &prefix_0x4b,
+  [0x4C] = &prefix_0x4c,
+  [0x4D] = &prefix_0x4d,
+  [0x4E] = &prefix_0x4e,
+  [0x4F] = &prefix_0x4f,
+
+  [0x50] = &prefix_0x50,
+  [0x51] = &prefix_0x51,
+  [0x52] = &prefix_0x52,
+  [0x53] = &prefix_0x53,
+  [0x54] = &prefix_0x54,
+  [0x55] = &prefix_0x55,
+  [0x56] = &prefix_0x56,
+  [0x57] = &prefix_0x57,
+  [0x58] = &prefix_0x58,
+  [0x59] = &prefix_0x59,
+  [0x5A] = &prefix_0x5a,
+  [0x5B] = &prefix_0x5b,
+  [0x5C] = &prefix_0x5c,
+  [0x5D] = &prefix_0x5d,
+  [0x5E] = &prefix_0x5e,
+  [0x5F] = &prefix_0x5f,
+
+  [0x60] = &prefix_0x60,
+  [0x61] = &prefix_0x61,
+  [0x62] = &prefix_0x62,
+  [0x63] = &prefix_0x63,
+  [0x64] = &prefix_0x64,
+  [0x65] = &prefix_0x65,
+  [0x66] = &prefix_0x66,
+  [0x67] = &prefix_0x67,
+  [0x68] = &prefix_0x68,
+  [0x69] = &prefix_0x69,
+  [0x6A] = &prefix_0x6a,
+  [0x6B] = &prefix_0x6b,
+  [0x6C] = &prefix_0x6c,
+  [0x6D] = &prefix_0x6d,
+  [0x6E] = &prefix_0x6e,
+  [0x6F] = &prefix_0x6f,
+
+  [0x70] = &prefix_0x70,
+  [0x71] = &prefix_0x71,
+  [0x72] = &prefix_0x72,
+  [0x73] = &prefix_0x73,
+  [0x74] = &prefix_0x74,
+  [0x75] = &prefix_0x75,
+  [0x76] = &prefix_0x76,
+  [0x77] = &prefix_0x77,
+  [0x78] = &prefix_0x78,
+  [0x79] = &prefix_0x79,
+  [0x7A] = &prefix_0x7a,
+  [0x7B] = &prefix_0x7b,
+  [0x7C] = &prefix_0x7c,
+  [0x7D] = &prefix_0x7d,
+  [0x7E] = &prefix_0x7e,
+  [0x7F] = &prefix_0x7f,
+
+  [0x80] = &prefix_0x80,
+  [0x81] = &prefix_0x81,
+  [0x82] = &prefix_0x82,
+  [0x83] = &prefix_0x83,
+  [0x84] = &prefix_0x84,
+  [0x85] = &prefix_0x85,
+  [0x86] = &prefix_0x86,
+  [0x87] = &prefix_0x87,
+  [0x88] = &prefix_0x88,
+  [0x89] = &prefix_0x89,
+  [0x8A] = &prefix_0x8a,
+  [0x8B] = &prefix_0x8b,
+  [0x8C] = &prefix_0x8c,
+  [0x8D] = &prefix_0x8d,
+  [0x8E] = &prefix_0x8e,
+  [0x8F] = &prefix_0x8f,
+
+  [0x90] = &prefix_0x90,
+  [0x91] = &prefix_0x91,
+  [0x92] = &prefix_0x92,
+  [0x93] = &prefix_0x93,
+  [0x94] = &prefix_0x94,
+  [0x95] = &prefix_0x95,
+  [0x96] = &prefix_0x96,
+  [0x97] = &prefix_0x97,
+  [0x98] = &prefix_0x98,
+  [0x99] = &prefix_0x99,
+  [0x9A] = &prefix_0x9a,
+  [0x9B] = &prefix_0x9b,
+  [0x9C] = &prefix_0x9c,
+  [0x9D] = &prefix_0x9d,
+  [0x9E] = &prefix_0x9e,
+  [0x9F] = &prefix_0x9f,
+
+  [0xA0] = &prefix_0xa0,
+  [0xA1] = &prefix_0xa1,
+  [0xA2] = &prefix_0xa2,
+  [0xA3] = &prefix_0xa3,
+  [0xA4] = &prefix_0xa4,
+  [0xA5] = &prefix_0xa5,
+  [0xA6] = &prefix_0xa6,
+  [0xA7] = &prefix_0xa7,
+  [0xA8] = &prefix_0xa8,
+  [0xA9] = &prefix_0xa9,
+  [0xAA] = &prefix_0xaa,
+  [0xAB] = &prefix_0xab,
+  [0xAC] = &prefix_0xac,
+  [0xAD] = &prefix_0xad,
+  [0xAE] = &prefix_0xae,
+  [0xAF] = &prefix_0xaf,
+
+  [0xB0] = &prefix_0xb0,
+  [0xB1] = &prefix_0xb1,
+  [0xB2] = &prefix_0xb2,
+  [0xB3] = &prefix_0xb3,
+  [0xB4] = &prefix_0xb4,
+  [0xB5] = &prefix_0xb5,
+  [0xB6] = &prefix_0xb6,
+  [0xB7] = &prefix_0xb7,
+  [0xB8] = &prefix_0xb8,
+  [0xB9] = &prefix_0xb9,
+  [0xBA] = &prefix_0xba,
+  [0xBB] = &prefix_0xbb,
+  [0xBC] = &prefix_0xbc,
+  [0xBD] = &prefix_0xbd,
+  [0xBE] = &prefix_0xbe,
+  [0xBF] = &prefix_0xbf,
+
+  [0xC0] = &prefix_0xc0,
+  [0xC1] = &prefix_0xc1,
+  [0xC2] = &prefix_0xc2,
+  [0xC3] = &prefix_0xc3,
+  [0xC4] = &prefix_0xc4,
+  [0xC5] = &prefix_0xc5,
+  [0xC6] = &prefix_0xc6,
+  [0xC7] = &prefix_0xc7,
+  [0xC8] = &prefix_0xc8,
+  [0xC9] = &prefix_0xc9,
+  [0xCA] = &prefix_0xca,
+  [0xCB] = &prefix_0xcb,
+  [0xCC] = &prefix_0xcc,
+  [0xCD] = &prefix_0xcd,
+  [0xCE] = &prefix_0xce,
+  [0xCF] = &prefix_0xcf,
+
+  [0xD0] = &prefix_0xd0,
+  [0xD1] = &prefix_0xd1,
+  [0xD2] = &prefix_0xd2,
+  [0xD3] = &prefix_0xd3,
+  [0xD4] = &prefix_0xd4,
+  [0xD5] = &prefix_0xd5,
+  [0xD6] = &prefix_0xd6,
+  [0xD7] = &prefix_0xd7,
+  [0xD8] = &prefix_0xd8,
+  [0xD9] = &prefix_0xd9,
+  [0xDA] = &prefix_0xda,
+  [0xDB] = &prefix_0xdb,
+  [0xDC] = &prefix_0xdc,
+  [0xDD] = &prefix_0xdd,
+  [0xDE] = &prefix_0xde,
+  [0xDF] = &prefix_0xdf,
+
+  [0xE0] = &prefix_0xe0,
+  [0xE1] = &prefix_0xe1,
+  [0xE2] = &prefix_0xe2,
+  [0xE3] = &prefix_0xe3,
+  [0xE4] = &prefix_0xe4,
+  [0xE5] = &prefix_0xe5,
+  [0xE6] = &prefix_0xe6,
+  [0xE7] = &prefix_0xe7,
+  [0xE8] = &prefix_0xe8,
+  [0xE9] = &prefix_0xe9,
+  [0xEA] = &prefix_0xea,
+  [0xEB] = &prefix_0xeb,
+  [0xEC] = &prefix_0xec,
+  [0xED] = &prefix_0xed,
+  [0xEE] = &prefix_0xee,
+  [0xEF] = &prefix_0xef,
+
+  [0xF0] = &prefix_0xf0,
+  [0xF1] = &prefix_0xf1,
+  [0xF2] = &prefix_0xf2,
+  [0xF3] = &prefix_0xf3,
+  [0xF4] = &prefix_0xf4,
+  [0xF5] = &prefix_0xf5,
+  [0xF6] = &prefix_0xf6,
+  [0xF7] = &prefix_0xf7,
+  [0xF8] = &prefix_0xf8,
+  [0xF9] = &prefix_0xf9,
+  [0xFA] = &prefix_0xfa,
+  [0xFB] = &prefix_0xfb,
+  [0xFC] = &prefix_0xfc,
+  [0xFD] = &prefix_0xfd,
+  [0xFE] = &prefix_0xfe,
+  [0xFF] = &prefix_0xff,
+};
+
+// Cycles the PPU spends in each mode before moving on, see timing.h
+static const uint16_t mode_length[4] = {
+  HBLANK_CYCLES, VBLANK_LINE_CYCLES, OAM_CYCLES, TRANSFER_CYCLES
+};
+
+static void schedule_ppu(GbContext *gb)
+{
+  scheduler_schedule(&gb->scheduler, EVENT_PPU, gb->clock.mode_start + mode_length[gb->clock.mode]);
+}
+
+void init_events(GbContext *gb)
+{
+  scheduler_init(&gb->scheduler);
+  schedule_ppu(gb);
+  scheduler_schedule(&gb->scheduler, EVENT_DIV, gb->clock.div_start + 256);
+  if (test_bit(gb->mmu.memory[0xFF07], 2))
+    scheduler_schedule(&gb->scheduler, EVENT_TIMER, gb->clock.timer_start + gb->clock.clock_speed);
+}
+
+// Value of the timer counter at the current cycle
+int get_timer_counter(GbContext *gb)
+{
+  if (test_bit(gb->mmu.memory[0xFF07], 2))
+    return gb->clock.cycles - gb->clock.timer_start;
+  return gb->clock.timer_counter;
+}
+
+// Restart the timer with the given counter once TAC has been written
+void set_timer_counter(GbContext *gb, int counter)
+{
+  if (test_bit(gb->mmu.memory[0xFF07], 2))
   {
-    my_clock.timer_counter += my_clock.m;
+    gb->clock.timer_start = gb->clock.cycles - counter;
+    scheduler_schedule(&gb->scheduler, EVENT_TIMER, gb->clock.timer_start + gb->clock.clock_speed);
+  }
+  else
+  {
+    gb->clock.timer_counter = counter;
+    scheduler_cancel(&gb->scheduler, EVENT_TIMER);
+  }
+}
 
-    if (my_clock.timer_counter >= my_clock.clock_speed)
-    {
-      my_clock.timer_counter = 0;
+void reset_divider(GbContext *gb)
+{
+  gb->mmu.memory[0xFF04] = 0;
+  gb->clock.div_start = gb->clock.cycles;
+  scheduler_schedule(&gb->scheduler, EVENT_DIV, gb->clock.div_start + 256);
+}
 
-      if (MMU.memory[0xFF05] == 255)
-      {
-          MMU.memory[0xFF05] = MMU.memory[0xFF06];
-          request_interupt(2);
-      }
-      else
-      {
-        MMU.memory[0xFF05]++;
-      }
-    }
+static void timer_event(GbContext *gb)
+{
+  gb->clock.timer_start = gb->clock.cycles;
+  scheduler_schedule(&gb->scheduler, EVENT_TIMER, gb->clock.timer_start + gb->clock.clock_speed);
+
+  if (gb->mmu.memory[0xFF05] == 255)
+  {
+      gb->mmu.memory[0xFF05] = gb->mmu.memory[0xFF06];
+      request_interupt(gb, 2);
+  }
+  else
+  {
+    gb->mmu.memory[0xFF05]++;
+  }
+}
+
+static void div_event(GbContext *gb)
+{
+  gb->clock.div_start = gb->clock.cycles;
+  scheduler_schedule(&gb->scheduler, EVENT_DIV, gb->clock.div_start + 256);
+  gb->mmu.memory[0xFF04]++;
+}
+
+// Update the coincidence flag, the STAT interupt is requested when LY
+// becomes equal to LYC.
+void check_coincidence(GbContext *gb)
+{
+  if (gb->mmu.memory[0xFF44] == gb->mmu.memory[0xFF45])
+  {
+    if (!test_bit(gb->mmu.memory[0xFF41], 2) && test_bit(gb->mmu.memory[0xFF41], 6))
+      request_interupt(gb, 1);
+    gb->mmu.memory[0xFF41] |= (1 << 2);
+  }
+  else
+  {
+    gb->mmu.memory[0xFF41] &= ~(1 << 2);
+  }
+}
+
+static int64_t elapsed_ns(const struct timespec *from, const struct timespec *to)
+{
+  return (to->tv_sec - from->tv_sec) * 1000000000L + (to->tv_nsec - from->tv_nsec);
+}
+
+void set_idle_handler(GbContext *gb, Idle_handler handler)
+{
+  gb->idle_handler = handler;
+}
+
+void set_cpu_report(GbContext *gb, int enable)
+{
+  gb->cpu_report = enable;
+}
+
+// Called when the CPU leaves HALT. Halted time is skipped at once, so in
+// power saving mode block the host until the wall clock catches up with
+// the current cycle instead of racing ahead and sleeping at VBLANK.
+void host_idle(GbContext *gb)
+{
+  if (!gb->idle_handler)
+    return;
+
+  int64_t ahead = pacer_ahead_ns(&gb->pacer, gb->clock.cycles);
+  if (ahead > 0 && ahead < gb->pacer.frame_ns)
+  {
+    struct timespec from, to;
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    gb->idle_handler(gb, ahead);
+    clock_gettime(CLOCK_MONOTONIC, &to);
+    gb->pacer.slept_ns += elapsed_ns(&from, &to);
   }
+}
+
+// Print the host CPU time spent for each emulated second
+static void report_cpu_usage(GbContext *gb)
+{
+  if (gb->clock.cycles - gb->report_cycles < SECOND_CYCLES)
+    return;
+
+  struct timespec cpu, wall;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+  clock_gettime(CLOCK_MONOTONIC_RAW, &wall);
 
-  if (my_clock.divider >= 256)
+  if (gb->report_cycles)
   {
-      my_clock.divider = 0;
-      MMU.memory[0xFF04]++;
+    int64_t cpu_ns = elapsed_ns(&gb->report_cpu, &cpu);
+    int64_t wall_ns = elapsed_ns(&gb->report_wall, &wall);
+    printf("cpu: %.1f ms per emulated second (%.1f%% of wall time)\n",
+           cpu_ns / 1e6, wall_ns ? 100.0 * cpu_ns / wall_ns : 0.0);
   }
+
+  gb->report_cycles = gb->clock.cycles;
+  gb->report_cpu = cpu;
+  gb->report_wall = wall;
 }
 
-static struct timespec start, end;
-static void my_clock_handling(uint8_t pixels[], int *display)
+static void ppu_event(GbContext *gb, uint8_t pixels[], int *display)
 {
-  my_clock.total_m += my_clock.m;
-  my_clock.total_t += my_clock.t;
-  my_clock.lineticks += my_clock.m;
-  update_timers();
+  gb->clock.mode_start = gb->clock.cycles;
 
-  switch (my_clock.mode)
+  switch (gb->clock.mode)
   {
     case 0:
-      if (my_clock.lineticks > 203)
+      if (gb->mmu.memory[0xFF44] == 143)
       {
-        if (MMU.memory[0xFF44] == 143)
-        {
-          my_clock.mode = 1;
-
-          MMU.memory[0xFF41] |= (1 << 0);
-          MMU.memory[0xFF41] &= ~(1 << 1);
-          if (test_bit(MMU.memory[0xFF41], 4))
-            request_interupt(1);
-        }
-        else
-        {
-          my_clock.mode = 2;
-          MMU.memory[0xFF41] |= (1 << 1);
-          MMU.memory[0xFF41] &= ~(1 << 0);
-          if (test_bit(MMU.memory[0xFF41], 5))
-            request_interupt(1);
-        }
-        my_clock.lineticks = 0;
-
-        uint8_t flag = MMU.memory[0xFF40];
-        if (test_bit(flag, 0))
-          print_tiles(pixels);
-        if (test_bit(flag, 1))
-          print_sprites(pixels);
-
-        MMU.memory[0xFF44] += 1;
+        gb->clock.mode = 1;
+
+        gb->mmu.memory[0xFF41] |= (1 << 0);
+        gb->mmu.memory[0xFF41] &= ~(1 << 1);
+        if (test_bit(gb->mmu.memory[0xFF41], 4))
+          request_interupt(gb, 1);
       }
-      break;
-    case 1: // VBLANK
-      if (my_clock.lineticks >= 456 && MMU.memory[0xFF44] == 153)
+      else
       {
-        my_clock.mode = 2;
-        my_clock.lineticks = 0;
-        MMU.memory[0xFF44] = 0;
-        request_interupt(0);
-
-        // BEGIN SYNCHRONIZED DISPLAY LOGIC
-        clock_gettime(CLOCK_MONOTONIC_RAW, &end);
-
-        struct timespec sleep;
-        sleep.tv_sec = 0;
-        // 20ms
-        sleep.tv_nsec = 16600000L - (end.tv_nsec - start.tv_nsec);
+        gb->clock.mode = 2;
+        gb->mmu.memory[0xFF41] |= (1 << 1);
+        gb->mmu.memory[0xFF41] &= ~(1 << 0);
+        if (test_bit(gb->mmu.memory[0xFF41], 5))
+          request_interupt(gb, 1);
+      }
 
-        if (sleep.tv_nsec > 0 && sleep.tv_nsec < 16600000L)
-          nanosleep(&sleep, NULL);
+      uint8_t flag = gb->mmu.memory[0xFF40];
+      if (test_bit(flag, 0))
+        print_tiles(gb, pixels);
+      if (test_bit(flag, 1))
+        print_sprites(gb, pixels);
 
-        my_clock.total_m  = 0;
+      gb->mmu.memory[0xFF44] += 1;
+      check_coincidence(gb);
+      break;
+    case 1: // VBLANK
+      if (gb->mmu.memory[0xFF44] == 153)
+      {
+        gb->clock.mode = 2;
+        gb->mmu.memory[0xFF44] = 0;
+        request_interupt(gb, 0);
 
+        // Wait until the frame is due, then show it
+        pacer_frame(&gb->pacer, gb->clock.cycles);
         *display = 1;
 
-        clock_gettime(CLOCK_MONOTONIC_RAW, &start);
-        // END SYNCHRONIZED DISPLAY LOGIC
+        if (gb->cpu_report)
+          report_cpu_usage(gb);
       }
-      else if (my_clock.lineticks >= 456)
+      else
       {
-        my_clock.lineticks = 0;
-        MMU.memory[0xFF44] += 1;
+        gb->mmu.memory[0xFF44] += 1;
       }
+      check_coincidence(gb);
       break;
     case 2:
-      if (my_clock.lineticks > 80)
-      {
-        my_clock.mode = 3;
-        my_clock.lineticks = 0;
-        MMU.memory[0xFF41] |= (1 << 0);
-        MMU.memory[0xFF41] |= (1 << 1);
-      }
+      gb->clock.mode = 3;
+      gb->mmu.memory[0xFF41] |= (1 << 0);
+      gb->mmu.memory[0xFF41] |= (1 << 1);
       break;
     case 3:
-      if (my_clock.lineticks > 172)
-      {
-        my_clock.mode = 0;
-        my_clock.lineticks = 0;
-        MMU.memory[0xFF41] &= ~(1 << 0);
-        MMU.memory[0xFF41] &= ~(1 << 1);
-        if (test_bit(MMU.memory[0xFF41], 3))
-          request_interupt(1);
-      }
+      gb->clock.mode = 0;
+      gb->mmu.memory[0xFF41] &= ~(1 << 0);
+      gb->mmu.memory[0xFF41] &= ~(1 << 1);
+      if (test_bit(gb->mmu.memory[0xFF41], 3))
+        request_interupt(gb, 1);
       break;
   }
 
-  // check the conincidence flag
-   if (MMU.memory[0xFF44] == MMU.memory[0xFF45])
-   {
-     MMU.memory[0xFF41] |= (1 << 2);
-     if (test_bit(MMU.memory[0xFF41], 6))
-       request_interupt(1);
-   }
-   else
-   {
-     MMU.memory[0xFF41] &= ~(1 << 2);
-   }
+  schedule_ppu(gb);
+}
+
+// Run every event due at the current cycle. The interupt check and the end
+// of a run are left to the caller, they are returned as a mask of
+// (1 << event).
+int run_events(GbContext *gb, uint8_t pixels[], int *display)
+{
+  int pending = 0;
+  int ev;
+
+  while ((ev = scheduler_pop(&gb->scheduler, gb->clock.cycles)) >= 0)
+  {
+    switch (ev)
+    {
+      case EVENT_PPU: ppu_event(gb, pixels, display); break;
+      case EVENT_TIMER: timer_event(gb); break;
+      case EVENT_DIV: div_event(gb); break;
+      default: pending |= (1 << ev); break;
+    }
+  }
+  return pending;
+}
+
+int my_clock_handling(GbContext *gb, uint16_t m, uint8_t pixels[], int *display)
+{
+  gb->clock.cycles += m;
+  if (gb->clock.cycles < gb->scheduler.next)
+    return 0;
+  return run_events(gb, pixels, display);
+}
+
+void prefixcb(GbContext *gb)
+{
+    uint8_t op = read_byte(gb);
+    if (!PrefixCB[op])
+    {
+      fprintf(stderr, "Unknown Prefix Op: 0x%x at 0x%x", op, gb->r.PC.val - 1);
+      exit(1);
+    }
+    PrefixCB[op](gb);
 }
 
-void execute(uint16_t op, uint8_t pixels[], int *display)
+void execute(GbContext *gb, uint16_t op, uint8_t pixels[], int *display)
 {
-  if (!MMU.HALT)
+  if (!gb->mmu.HALT)
   {
     if (!Opcodes[op])
     {
-      fprintf(stderr, "Unknown Op %x at address %x", op, r.PC.val - 1);
+      fprintf(stderr, "Unknown Op %x at address %x", op, gb->r.PC.val - 1);
       exit(1);
     }
-    Opcodes[op]();
+    Opcodes[op](gb);
   }
 
-  my_clock_handling(pixels, display);
+  my_clock_handling(gb, gb->clock.m, pixels, display);
 }
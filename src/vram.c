@@ -1,70 +1,170 @@
 #include "vram.h"
+#include <string.h>
+#include "utils.h"
+#include "pixel.h"
 
-extern Mmu MMU;
-extern Registers r;
-extern My_clock my_clock;
-extern void (*Opcodes[0xFF + 1]) (void);
-extern void (*PrefixCB[0xFF + 1]) (void);
-static int WIDTH = (160 + 320) * 2;
-static int HEIGHT = 144 * 2 + 100;
+typedef struct Colour_scheme
+{
+  const char *name;
+  uint8_t shades[4][3];
+} Colour_scheme;
+
+static const Colour_scheme schemes[] = {
+  { "grey", { { 255, 255, 255 }, { 0xCC, 0xCC, 0xCC }, { 0x77, 0x77, 0x77 }, { 0, 0, 0 } } },
+  { "dmg", { { 0x9B, 0xBC, 0x0F }, { 0x8B, 0xAC, 0x0F }, { 0x30, 0x62, 0x30 }, { 0x0F, 0x38, 0x0F } } },
+  { "pocket", { { 0xC4, 0xCF, 0xA1 }, { 0x8B, 0x95, 0x6D }, { 0x4D, 0x53, 0x3C }, { 0x1F, 0x1F, 0x1F } } },
+};
+
+void video_cache_reset(GbContext *gb)
+{
+  memset(gb->tiles.stale, 1, sizeof(gb->tiles.stale));
+  memset(gb->bg.cell_version, 0, sizeof(gb->bg.cell_version));
+  gb->palettes.stale = 1;
+}
+
+static void palette_build(GbContext *gb, uint32_t lut[4], uint8_t shades[4], uint8_t palette, int transparent)
+{
+  const Colour_scheme *scheme = &schemes[gb->palettes.scheme];
+  for (int c = 0; c < 4; c++)
+  {
+    int shade = (palette >> (c * 2)) & 3;
+    const uint8_t *rgb = scheme->shades[shade];
+    lut[c] = (transparent && shade == 0) ? 0 : pixel_argb(255, rgb[0], rgb[1], rgb[2]);
+    shades[c] = shade;
+  }
+}
+
+void palette_update(GbContext *gb, uint16_t addr)
+{
+  uint8_t palette = gb->mmu.memory[addr];
+  if (addr != 0xFF47)
+  {
+    int obp = addr - 0xFF48;
+    palette_build(gb, gb->palettes.obp[obp], gb->palettes.obp_shade[obp], palette, 1);
+    return;
+  }
+
+  // The background planes hold BGP colours, redraw them if those changed
+  uint32_t lut[4];
+  uint8_t shades[4];
+  palette_build(gb, lut, shades, palette, 0);
+  if (memcmp(lut, gb->palettes.bgp, sizeof(lut)) || memcmp(shades, gb->palettes.bgp_shade, sizeof(shades)))
+  {
+    memcpy(gb->palettes.bgp, lut, sizeof(lut));
+    memcpy(gb->palettes.bgp_shade, shades, sizeof(shades));
+    memset(gb->bg.cell_version, 0, sizeof(gb->bg.cell_version));
+  }
+}
+
+static void palette_refresh(GbContext *gb)
+{
+  if (!gb->palettes.stale)
+    return;
+  for (uint16_t addr = 0xFF47; addr <= 0xFF49; addr++)
+    palette_update(gb, addr);
+  gb->palettes.stale = 0;
+}
+
+int palette_set_scheme(GbContext *gb, const char *name)
+{
+  for (unsigned i = 0; i < sizeof(schemes) / sizeof(schemes[0]); i++)
+  {
+    if (strcmp(schemes[i].name, name) == 0)
+    {
+      gb->palettes.scheme = i;
+      gb->palettes.stale = 1;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+static void decode_tile(GbContext *gb, int tile)
+{
+  const uint8_t *data = &gb->mmu.memory[0x8000 + tile * 16];
+  for (int row = 0; row < 8; row++)
+  {
+    for (int x = 0; x < 8; x++)
+    {
+      int bit = 7 - x;
+      gb->tiles.pixels[tile][row][x] = ((data[row * 2] >> bit) & 1)
+        | (((data[row * 2 + 1] >> bit) & 1) << 1);
+    }
+  }
+  gb->tiles.stale[tile] = 0;
+  gb->tiles.version[tile]++;
+}
+
+static void tile_update(GbContext *gb, int tile)
+{
+  if (gb->tiles.stale[tile])
+    decode_tile(gb, tile);
+}
 
-static void print_tile(uint8_t pixels[], uint16_t addr, int x, int y)
+// Colour indices, left to right, of the tile row whose first byte is at
+// `addr` in 0x8000-0x97FF
+static const uint8_t *tile_pixels(GbContext *gb, uint16_t addr)
+{
+  int tile = (addr - 0x8000) >> 4;
+  tile_update(gb, tile);
+  return gb->tiles.pixels[tile][(addr >> 1) & 7];
+}
+
+static void print_tile(GbContext *gb, uint8_t pixels[], uint16_t addr, int x, int y)
 {
   for (uint16_t i = 0; i < 8; i++)
   {
-    uint16_t l1 = addr + (i * 2);
-    uint16_t l2 = addr + (i * 2) + 1;
+    const uint8_t *row = tile_pixels(gb, addr + i * 2);
 
     for (uint16_t j = 0; j < 8; j++)
     {
-      uint8_t d = 1 << (7 - j);
-      uint8_t val = ((MMU.memory[l1] & d) ? 1 : 0) + ((MMU.memory[l2] & d) ? 2 : 0);
+      uint8_t val = row[j];
 
-      uint8_t red = 0;
-      uint8_t green = 0;
-      uint8_t blue = 0;
+      uint8_t grey = 0;
       switch (val)
       {
-        case 1:
-          red = 192;
-          green = 192;
-          blue = 192;
-          break;
-        case 2:
-          red = 96;
-          green = 96;
-          blue = 96;
-          break;
+        case 1: grey = 192; break;
+        case 2: grey = 96; break;
       }
       if (val > 0)
       {
-        unsigned int offset = (WIDTH * 4 * (y + i)) + (x + j) * 4;
-        pixels[offset] = red;
-        pixels[offset + 1] = green;
-        pixels[offset + 2] = blue;
-        pixels[offset + 3] = 255;
+        uint32_t pixel = pixel_argb(255, grey, grey, grey);
+        memcpy(&pixels[(VRAM_VIEW_WIDTH * (y + i) + x + j) * 4], &pixel, 4);
       }
     }
   }
 }
 
-void print_sprites(uint8_t pixels[])
+// Sprite rows are drawn left to right from bit 7, mirror them for X flip
+static uint8_t flip_bits(uint8_t b)
+{
+  b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+  b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+  return (b & 0xAA) >> 1 | (b & 0x55) << 1;
+}
+
+void print_sprites(GbContext *gb, uint8_t pixels[])
 {
-  uint8_t flags = MMU.memory[0xFF40];
+  uint8_t flags = gb->mmu.memory[0xFF40];
+  int scanline = gb->mmu.memory[0xFF44];
+  if (scanline >= SCREEN_HEIGHT)
+    return;
+
   uint8_t double_sprite = test_bit(flags, 2);
   uint8_t nb_sprites = 0;
+  const Pixel_kernel *kernel = pixel_kernel();
+  palette_refresh(gb);
 
   for (int i = 0; i < 40; i++)
   {
     int index = i * 4;
-    int yPos = MMU.memory[0xFE00 + index] - 16;
-    int xPos = MMU.memory[0xFE00 + index + 1] - 8;
-    int tileLocation = MMU.memory[0xFE00 + index + 2];
-    int attributes = MMU.memory[0xFE00 + index + 3];
+    int yPos = gb->mmu.memory[0xFE00 + index] - 16;
+    int xPos = gb->mmu.memory[0xFE00 + index + 1] - 8;
+    int tileLocation = gb->mmu.memory[0xFE00 + index + 2];
+    int attributes = gb->mmu.memory[0xFE00 + index + 3];
 
     int yFlip = test_bit(attributes, 6);
     int xFlip = test_bit(attributes, 5);
-    int scanline = MMU.memory[0xFF44];
     int ysize = double_sprite ? 16 : 8;
 
     if ((scanline >= yPos) && (scanline < (yPos + ysize)) && nb_sprites < 10)
@@ -76,161 +176,126 @@ void print_sprites(uint8_t pixels[])
 
       line *= 2;
       uint16_t dataAddress = (0x8000 + (tileLocation * 16)) + line;
-      uint8_t data1 = MMU.memory[dataAddress];
-      uint8_t data2 = MMU.memory[dataAddress + 1];
+      uint8_t lo = gb->mmu.memory[dataAddress];
+      uint8_t hi = gb->mmu.memory[dataAddress + 1];
+      if (xFlip)
+      {
+        lo = flip_bits(lo);
+        hi = flip_bits(hi);
+      }
+      int obp = test_bit(attributes, 4);
+      uint8_t *out = &pixels[SCREEN_WIDTH * 4 * scanline];
+      uint8_t *shades = &gb->shades[SCREEN_WIDTH * scanline];
+
+      // Pixels off the sides of the screen are dropped, a row crossing one
+      // goes through a copy
+      if (xPos >= 0 && xPos <= SCREEN_WIDTH - 8)
+        kernel->expand_masked(lo, hi, gb->palettes.obp[obp], &out[xPos * 4]);
+      else
+      {
+        uint8_t row[32] = { 0 };
+        for (int k = 0; k < 8; k++)
+          if (xPos + k >= 0 && xPos + k < SCREEN_WIDTH)
+            memcpy(&row[k * 4], &out[(xPos + k) * 4], 4);
+        kernel->expand_masked(lo, hi, gb->palettes.obp[obp], row);
+        for (int k = 0; k < 8; k++)
+          if (xPos + k >= 0 && xPos + k < SCREEN_WIDTH)
+            memcpy(&out[(xPos + k) * 4], &row[k * 4], 4);
+      }
 
-      for (int tilePixel = 7; tilePixel >= 0; tilePixel--)
+      for (int k = 0; k < 8; k++)
       {
-        int colourbit = tilePixel;
-        if (xFlip)
-          colourbit = -(colourbit - 7);
-
-         int colourNum = test_bit(data2, colourbit);
-         colourNum <<= 1;
-         colourNum |= test_bit(data1, colourbit);
-
-         int col = 0;
-         uint8_t palette = MMU.memory[(test_bit(attributes, 4) ? 0xFF49 : 0xFF48)];
-         int hi = 0;
-         int lo = 0;
-
-         switch (colourNum)
-         {
-           case 0: hi = 1; lo = 0; break;
-           case 1: hi = 3; lo = 2; break;
-           case 2: hi = 5; lo = 4; break;
-           case 3: hi = 7; lo = 6; break;
-         }
-
-         int colour = 0;
-         colour = test_bit(palette, hi) << 1;
-         colour |= test_bit(palette, lo);
-         col = colour;
-
-         if (col == 0)
-           continue;
-
-         int red = 0;
-         int green = 0;
-         int blue = 0;
-
-         switch(col)
-         {
-          case 0:	red = 255; green = 255; blue = 255; break;
-          case 1: red = 0xCC; green = 0xCC; blue = 0xCC; break;
-          case 2:	red = 0x77; green = 0x77; blue = 0x77; break;
-         }
-
-         int pixel = xPos - tilePixel + 7;
-         const unsigned int offset = (WIDTH * 4 * scanline) + pixel * 4;
-         if (offset < (unsigned int)(WIDTH*HEIGHT*4))
-         {
-           pixels[offset] = red;
-           pixels[offset + 1] = green;
-           pixels[offset + 2] = blue;
-           pixels[offset + 3] = 255;
-        } else {
-          //printf("offset > screen -> offset = %d\n", offset);
-        }
-       }
-     }
+        int bit = 7 - k;
+        uint8_t shade = gb->palettes.obp_shade[obp][((lo >> bit) & 1) | (((hi >> bit) & 1) << 1)];
+        if (shade && xPos + k >= 0 && xPos + k < SCREEN_WIDTH)
+          shades[xPos + k] = shade;
+      }
+    }
   }
 }
 
-void print_tiles(uint8_t pixels[])
+// Redraw the cell at `cell` of map `map` if its tile changed since
+static void bg_cell(GbContext *gb, int map, int cell, uint8_t tile_set)
 {
-  uint8_t scrollY  = MMU.memory[0xFF42];
-  uint8_t scrollX  = MMU.memory[0xFF43];
-  uint8_t windowY  = MMU.memory[0xFF4A];
-  uint8_t windowX  = MMU.memory[0xFF4B] - 7;
-  uint8_t flags    = MMU.memory[0xFF40];
-  uint8_t window   = (test_bit(flags, 5) && (windowY <= MMU.memory[0xFF44]));
-  uint8_t tile_map = test_bit(flags, 3);
-  uint8_t tile_set = test_bit(flags, 4);
-
-  if (test_bit(flags, 0))
+  uint8_t index = gb->mmu.memory[(map ? 0x9C00 : 0x9800) + cell];
+  uint16_t tile = tile_set ? index : 256 + (int8_t)index;
+  tile_update(gb, tile);
+  if (gb->bg.cell_tile[map][cell] == tile
+      && gb->bg.cell_version[map][cell] == gb->tiles.version[tile])
+    return;
+
+  const Pixel_kernel *kernel = pixel_kernel();
+  const uint8_t *data = &gb->mmu.memory[0x8000 + tile * 16];
+  const int x = (cell % 32) * 8;
+  const int y = (cell / 32) * 8;
+  for (int i = 0; i < 8; i++)
   {
-    uint16_t start_tile = 0;
-    if (!window)
-      start_tile = tile_map ? 0x9c00 : 0x9800;
-    else
-      start_tile = test_bit(flags, 6) ? 0x9c00 : 0x9800;
-
-    uint16_t start_set = tile_set ? 0x8000 : 0x8800;
-
-    uint8_t y = (window ? MMU.memory[0xFF44] - windowY : MMU.memory[0xFF44] + scrollY);
-    uint16_t tile_row = ((uint8_t)(y / 8)) * 32;
-
-    for (int j = 0; j < 160; j++)
-    {
-      uint8_t x = j + scrollX;
-      if (window && (j >= windowX))
-        x = j - windowX;
-
-      uint16_t tile_col = x / 8;
-      uint16_t addr = start_tile + tile_row + tile_col;
-      uint16_t tile_loc = start_set;
-      if (!tile_set)
-        tile_loc += (((int)(((int8_t)MMU.memory[addr]))) + 128) * 16;
-      else
-        tile_loc += ((uint16_t)MMU.memory[addr]) * 16;
-
-      uint8_t line = (y % 8) * 2;
-      uint8_t data1 = MMU.memory[tile_loc + line];
-      uint8_t data2 = MMU.memory[tile_loc + line + 1];
-
-      int colourBit = x % 8;
-      colourBit -= 7;
-      colourBit *= -1;
-
-      int colourNum = test_bit(data2, colourBit);
-      colourNum <<= 1;
-      colourNum |= test_bit(data1, colourBit);
-
-      int col = 0;
-      uint8_t palette = MMU.memory[0xFF47];
-      int hi = 0;
-      int lo = 0;
+    const uint8_t *row = gb->tiles.pixels[tile][i];
+    kernel->expand(data[i * 2], data[i * 2 + 1], gb->palettes.bgp, &gb->bg.plane[map][y + i][x * 4]);
+    for (int j = 0; j < 8; j++)
+      gb->bg.shade[map][y + i][x + j] = gb->palettes.bgp_shade[row[j]];
+  }
+  gb->bg.cell_tile[map][cell] = tile;
+  gb->bg.cell_version[map][cell] = gb->tiles.version[tile];
+}
 
-      switch (colourNum)
-      {
-        case 0: hi = 1; lo = 0; break;
-        case 1: hi = 3; lo = 2; break;
-        case 2: hi = 5; lo = 4; break;
-        case 3: hi = 7; lo = 6; break;
-      }
+// Copy `count` pixels of line `y` of a map plane from `x` on to screen
+// pixel `out`, wrapping around at 256, making sure the cells they come from
+// are up to date
+static void bg_copy(GbContext *gb, uint8_t pixels[], int out, int map, uint8_t x, uint8_t y, int count, uint8_t tile_set)
+{
+  for (int c = x / 8; c <= (x + count - 1) / 8; c++)
+    bg_cell(gb, map, (y / 8) * 32 + c % 32, tile_set);
+
+  const uint8_t *line = gb->bg.plane[map][y];
+  const uint8_t *shades = gb->bg.shade[map][y];
+  int first = count < 256 - x ? count : 256 - x;
+  memcpy(&pixels[out * 4], &line[x * 4], first * 4);
+  memcpy(&pixels[(out + first) * 4], line, (count - first) * 4);
+  memcpy(&gb->shades[out], &shades[x], first);
+  memcpy(&gb->shades[out + first], shades, count - first);
+}
 
-      int colour = 0;
-      colour = test_bit(palette, hi) << 1;
-      colour |= test_bit(palette, lo) ;
-      col = colour;
+void print_tiles(GbContext *gb, uint8_t pixels[])
+{
+  uint8_t scrollY  = gb->mmu.memory[0xFF42];
+  uint8_t scrollX  = gb->mmu.memory[0xFF43];
+  uint8_t windowY  = gb->mmu.memory[0xFF4A];
+  uint8_t windowX  = gb->mmu.memory[0xFF4B] - 7;
+  uint8_t flags    = gb->mmu.memory[0xFF40];
+  uint8_t scanline = gb->mmu.memory[0xFF44];
+  uint8_t window   = (test_bit(flags, 5) && (windowY <= scanline));
+  uint8_t tile_set = test_bit(flags, 4);
 
-      int red = 0;
-      int green = 0;
-      int blue = 0;
+  if (!test_bit(flags, 0) || scanline >= SCREEN_HEIGHT)
+    return;
 
-      switch(col)
-      {
-       case 0: red = 255; green = 255; blue = 255; break;
-       case 1: red = 0xCC; green = 0xCC; blue = 0xCC; break;
-       case 2: red = 0x77; green = 0x77; blue = 0x77; break;
-      }
+  palette_refresh(gb);
 
-      const unsigned int offset = (WIDTH * 4 * MMU.memory[0xFF44]) + j * 4;
-      pixels[offset] = red;
-      pixels[offset + 1] = green;
-      pixels[offset + 2] = blue;
-      pixels[offset + 3] = 255;
-    }
+  int out = SCREEN_WIDTH * scanline;
+  if (!window)
+  {
+    bg_copy(gb, pixels, out, test_bit(flags, 3), scrollX, scanline + scrollY, 160, tile_set);
+    return;
   }
+
+  // Once the window starts on a line the whole line is read from the
+  // window map, scrolled by SCX left of WX
+  int map = test_bit(flags, 6);
+  uint8_t y = scanline - windowY;
+  int split = windowX < 160 ? windowX : 160;
+  if (split > 0)
+    bg_copy(gb, pixels, out, map, scrollX, y, split, tile_set);
+  if (split < 160)
+    bg_copy(gb, pixels, out + split, map, 0, y, 160 - split, tile_set);
 }
 
-void print_vram(uint8_t pixels[])
+void print_vram(GbContext *gb, uint8_t pixels[])
 {
   int i = 0;
   for (uint16_t j = 0x8000; j < 0x9800; j += 8*2)
   {
-    print_tile(pixels, j, (i % 32) * 8 + 160, (i / 32) * 8);
+    print_tile(gb, pixels, j, (i % 32) * 8, (i / 32) * 8);
     i++;
   }
 }
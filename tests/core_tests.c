@@ -0,0 +1,206 @@
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "gb.h"
+#include "cpu.h"
+#include "helpers.h"
+
+// The switch core of cpu.c against the Opcodes and PrefixCB tables of
+// utils.c, the reference it was written from
+
+static GbContext *machine;
+static uint8_t memory[0x10000];
+
+static int init_core_suite(void)
+{
+  machine = gb_create("misc/Tetris.gb");
+  return machine == NULL;
+}
+
+static int clean_core_suite(void)
+{
+  gb_destroy(machine);
+  return 0;
+}
+
+// One instruction through the tables, the way the debugger steps
+static void table_step(GbContext *gb)
+{
+  int display = 0;
+  uint8_t op = read_byte(gb);
+  if (gb->mmu.HALT)
+    gb->r.PC.val--;
+  execute(gb, op, gb->framebuffer, &display);
+  do_interupt(gb);
+}
+
+static void core_step(GbContext *gb)
+{
+  int display = 0;
+  cpu_run(gb, gb->framebuffer, &display, 1);
+}
+
+static int same_registers(const Registers *x, const Registers *y)
+{
+  return x->AF.val == y->AF.val && x->BC.val == y->BC.val
+    && x->DE.val == y->DE.val && x->HL.val == y->HL.val
+    && x->SP.val == y->SP.val && x->PC.val == y->PC.val
+    && x->ime == y->ime;
+}
+
+// Opcodes the reference does not run: unused ones and STOP, which exits
+static int skipped(int op)
+{
+  static const uint8_t ops[] = {
+    0x10, 0xD3, 0xDB, 0xDD, 0xE3, 0xE4, 0xEB, 0xEC, 0xED, 0xF4, 0xFC, 0xFD
+  };
+  for (unsigned i = 0; i < sizeof(ops); i++)
+    if (op == ops[i])
+      return 1;
+  return 0;
+}
+
+// Every opcode, then every CB one, from the same random registers and RAM
+// through both. Registers, flags, memory, cycles and HALT must agree.
+static void test_opcodes(void)
+{
+  GbContext *gb = machine;
+  gb->mmu.BIOS_MODE = 0;
+  map_pages(gb);
+  srand(1234);
+
+  for (int round = 0; round < 3; round++)
+  {
+    for (int op = 0; op < 0x200; op++)
+    {
+      if (skipped(op))
+        continue;
+
+      for (int i = 0xC000; i < 0xFF00; i++)
+        gb->mmu.memory[i] = rand();
+      gb->mmu.memory[0xFF0F] = rand() & 0x1F;
+      gb->mmu.memory[0xFFFF] = rand() & 0x1F;
+      Registers r;
+      r.AF.val = rand() & 0xFFF0;
+      r.BC.val = rand();
+      r.DE.val = rand();
+      r.HL.val = (rand() & 1) ? 0xC000 + (rand() & 0x1FFF) : rand();
+      r.SP.val = 0xC100 + (rand() & 0x1E00);
+      r.PC.val = 0xD000;
+      r.ime = rand() & 1;
+      r.joypad = 0xFF;
+      if (op < 0x100)
+        gb->mmu.memory[0xD000] = op;
+      else
+      {
+        gb->mmu.memory[0xD000] = 0xCB;
+        gb->mmu.memory[0xD001] = op & 0xFF;
+      }
+
+      memcpy(memory, gb->mmu.memory, sizeof(memory));
+      My_clock clock = gb->clock;
+      Scheduler scheduler = gb->scheduler;
+      gb->r = r;
+      gb->mmu.HALT = 0;
+      table_step(gb);
+      Registers table_r = gb->r;
+      uint64_t table_cycles = gb->clock.cycles;
+      uint8_t table_halt = gb->mmu.HALT;
+      static uint8_t table_memory[0x10000];
+      memcpy(table_memory, gb->mmu.memory, sizeof(table_memory));
+
+      memcpy(gb->mmu.memory, memory, sizeof(memory));
+      gb->clock = clock;
+      gb->scheduler = scheduler;
+      gb->r = r;
+      gb->mmu.HALT = 0;
+      map_pages(gb);
+      core_step(gb);
+
+      CU_ASSERT(same_registers(&table_r, &gb->r));
+      CU_ASSERT(table_cycles == gb->clock.cycles);
+      CU_ASSERT(table_halt == gb->mmu.HALT);
+      CU_ASSERT(memcmp(table_memory, gb->mmu.memory, sizeof(table_memory)) == 0);
+    }
+  }
+}
+
+// Both from power on, through the BIOS and into the game with some input,
+// one instruction at a time
+static void test_lockstep(void)
+{
+  GbContext *a = gb_create("misc/Tetris.gb");
+  GbContext *b = gb_create("misc/Tetris.gb");
+  int mismatches = 0;
+  uint64_t frame_cycles = 0;
+  int frame = 0;
+
+  while (frame < 600 && mismatches < 10)
+  {
+    // Start a few times to get through the menus
+    uint8_t joypad = (frame >= 400 && frame % 60 < 5) ? 0x7F : 0xFF;
+    joypad_set(a, joypad);
+    joypad_set(b, joypad);
+
+    table_step(a);
+    core_step(b);
+    if (!same_registers(&a->r, &b->r) || a->clock.cycles != b->clock.cycles
+        || a->mmu.HALT != b->mmu.HALT)
+      mismatches++;
+
+    if (a->clock.cycles - frame_cycles >= FRAME_CYCLES)
+    {
+      frame_cycles = a->clock.cycles;
+      frame++;
+      if (memcmp(a->mmu.memory, b->mmu.memory, sizeof(a->mmu.memory)))
+        mismatches++;
+    }
+  }
+  CU_ASSERT(mismatches == 0);
+  CU_ASSERT(frame == 600);
+
+  gb_destroy(a);
+  gb_destroy(b);
+}
+
+static void test_halt(void)
+{
+  GbContext *gb = machine;
+  gb->mmu.BIOS_MODE = 0;
+  map_pages(gb);
+  gb->mmu.memory[0xD000] = 0x76;
+  gb->mmu.memory[0xD001] = 0x00;
+  gb->mmu.memory[0xFFFF] = 0x01;
+
+  // Waits for the VBLANK interupt
+  gb->r.PC.val = 0xD000;
+  gb->r.ime = 0;
+  gb->mmu.HALT = 0;
+  gb->mmu.memory[0xFF0F] = 0x00;
+  core_step(gb);
+  CU_ASSERT(gb->mmu.HALT);
+  CU_ASSERT(gb->r.PC.val == 0xD001);
+
+  // Already pending, the CPU carries on with the next instruction
+  gb->r.PC.val = 0xD000;
+  gb->mmu.HALT = 0;
+  gb->mmu.memory[0xFF0F] = 0x01;
+  core_step(gb);
+  CU_ASSERT(!gb->mmu.HALT);
+  core_step(gb);
+  CU_ASSERT(gb->r.PC.val == 0xD002);
+}
+
+int add_core_suite(void)
+{
+  CU_pSuite pSuite = CU_add_suite("core_suite", init_core_suite, clean_core_suite);
+  if (NULL == pSuite)
+    return 1;
+
+  if ((NULL == CU_add_test(pSuite, "test of every opcode against the tables", test_opcodes))
+    || (NULL == CU_add_test(pSuite, "test of the cores in lockstep", test_lockstep))
+    || (NULL == CU_add_test(pSuite, "test of HALT with an interupt pending", test_halt))
+  )
+    return 1;
+  return 0;
+}
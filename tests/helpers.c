@@ -2,24 +2,33 @@
 
 #define LAMBDA(c_) ({ c_ _;})
 
-int check_flags(int Z, int N, int H, int C)
+GbContext *gb;
+
+int check_flags(GbContext *gb, int Z, int N, int H, int C)
+{
+    return getZ(gb) == Z && getN(gb) == N && getH(gb) == H && getC(gb) == C;
+}
+
+// Run one instruction, the frame it may finish is not looked at
+static void execute_op(GbContext *gb, uint8_t op)
 {
-    return getZ() == Z && getN() == N && getH() == H && getC() == C;
+  int display = 0;
+  execute(gb, op, gb->framebuffer, &display);
 }
 
-void init_execute_byte(uint8_t op)
+void init_execute_byte(GbContext *gb, uint8_t op)
 {
-  init_registers();
-  MMU.memory[0] = op;
-  execute(read_byte());
+  init_registers(gb);
+  gb->mmu.memory[0] = op;
+  execute_op(gb, read_byte(gb));
 }
 
 void test_8(uint8_t op, void (*init)(void), void (*condition)(void))
 {
-  init_registers();
-  MMU.memory[0] = op;
+  init_registers(gb);
+  gb->mmu.memory[0] = op;
   init();
-  execute(read_byte());
+  execute_op(gb, read_byte(gb));
 
   condition();
 }
@@ -32,10 +41,10 @@ void test_inc_normal(uint8_t op, uint8_t *reg, void (*custom_init)(void))
       custom_init();
     }),
     LAMBDA(void _(void) {
-      CU_ASSERT(check_flags(0, 0, 0, 0));
+      CU_ASSERT(check_flags(gb, 0, 0, 0, 0));
       CU_ASSERT(*reg == 1);
-      CU_ASSERT(r.SP.val == 0);
-      CU_ASSERT(r.PC.val == 1);
+      CU_ASSERT(gb->r.SP.val == 0);
+      CU_ASSERT(gb->r.PC.val == 1);
     })
   );
 }
@@ -48,10 +57,10 @@ void test_dec_normal(uint8_t op, uint8_t *reg, void (*custom_init)(void))
       custom_init();
     }),
     LAMBDA(void _(void) {
-      CU_ASSERT(check_flags(0, 1, 0, 0));
+      CU_ASSERT(check_flags(gb, 0, 1, 0, 0));
       CU_ASSERT(*reg == 1);
-      CU_ASSERT(r.SP.val == 0);
-      CU_ASSERT(r.PC.val == 1);
+      CU_ASSERT(gb->r.SP.val == 0);
+      CU_ASSERT(gb->r.PC.val == 1);
     })
   );
 }
@@ -64,10 +73,10 @@ void test_inc_overflow(uint8_t op, uint8_t *reg, void (*custom_init)(void))
       custom_init();
     }),
     LAMBDA(void _(void) {
-      CU_ASSERT(check_flags(1, 0, 1, 0));
+      CU_ASSERT(check_flags(gb, 1, 0, 1, 0));
       CU_ASSERT(*reg == 0);
-      CU_ASSERT(r.SP.val == 0);
-      CU_ASSERT(r.PC.val == 1);
+      CU_ASSERT(gb->r.SP.val == 0);
+      CU_ASSERT(gb->r.PC.val == 1);
     })
   );
 }
@@ -80,7 +89,7 @@ void test_inc_half(uint8_t op, uint8_t *reg, void (*custom_init)(void))
       custom_init();
     }),
     LAMBDA(void _(void) {
-      CU_ASSERT(check_flags(0, 0, 1, 0));
+      CU_ASSERT(check_flags(gb, 0, 0, 1, 0));
     })
   );
 
@@ -90,7 +99,7 @@ void test_inc_half(uint8_t op, uint8_t *reg, void (*custom_init)(void))
       custom_init();
     }),
     LAMBDA(void _(void) {
-      CU_ASSERT(check_flags(0, 0, 1, 0));
+      CU_ASSERT(check_flags(gb, 0, 0, 1, 0));
     })
   );
 
@@ -100,7 +109,7 @@ void test_inc_half(uint8_t op, uint8_t *reg, void (*custom_init)(void))
       custom_init();
     }),
     LAMBDA(void _(void) {
-      CU_ASSERT(check_flags(0, 0, 0, 0));
+      CU_ASSERT(check_flags(gb, 0, 0, 0, 0));
     })
   );
 }
@@ -4,11 +4,22 @@
 #include "CUnit/Basic.h"
 #include "utils.h"
 
-int check_flags(int Z, int N, int H, int C);
-void init_execute_byte(uint8_t op);
+// Machine the tests run on, created by the suite
+extern GbContext *gb;
+
+int check_flags(GbContext *gb, int Z, int N, int H, int C);
+void init_execute_byte(GbContext *gb, uint8_t op);
 void test_8(uint8_t op, void (*init)(void), void (*condition)(void));
 void test_inc_normal(uint8_t op, uint8_t *reg, void (*custom_init)(void));
 void test_inc_overflow(uint8_t op, uint8_t *reg, void (*custom_init)(void));
 void test_inc_half(uint8_t op, uint8_t *reg, void (*custom_init)(void));
 
+// Suites of the other test files, 0 once added
+int add_scheduler_suite(void);
+int add_state_suite(void);
+int add_rewind_suite(void);
+int add_movie_suite(void);
+int add_video_suite(void);
+int add_core_suite(void);
+
 #endif /* HELPERS_H */
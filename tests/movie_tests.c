@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "CUnit/Basic.h"
+#include "gb.h"
+#include "movie.h"
+#include "helpers.h"
+
+#define MOVIE_PATH "movie_tests.gbmv"
+#define FRAMES 900
+
+static Movie recorded;
+static uint64_t recorded_hash;
+
+static int init_movie_suite(void)
+{
+  movie_init(&recorded);
+  return 0;
+}
+
+static int clean_movie_suite(void)
+{
+  movie_free(&recorded);
+  return 0;
+}
+
+// Start through the menus then some moves, one bit cleared per held button
+static uint8_t script(uint32_t frame)
+{
+  if ((frame >= 400 && frame < 405) || (frame >= 460 && frame < 465)
+      || (frame >= 520 && frame < 525))
+    return 0x7F;    // start
+  if (frame % 40 < 4)
+    return 0xEF;    // A
+  if (frame % 40 >= 20 && frame % 40 < 30)
+    return 0xFD;    // left
+  return 0xFF;
+}
+
+// Run `frames` frames from power on with the input of `m`, or none
+static uint64_t replay(Movie *m, uint32_t frames)
+{
+  GbContext *gb = gb_create("misc/Tetris.gb");
+  for (uint32_t frame = 0; frame < frames; frame++)
+  {
+    gb_set_joypad(gb, m ? movie_input(m, frame) : 0xFF);
+    gb_run_frame(gb);
+  }
+  uint64_t hash = gb_screen_hash(gb);
+  gb_destroy(gb);
+  return hash;
+}
+
+static void test_record(void)
+{
+  GbContext *gb = gb_create("misc/Tetris.gb");
+  for (uint32_t frame = 0; frame < FRAMES; frame++)
+  {
+    uint8_t joypad = script(frame);
+    gb_set_joypad(gb, joypad);
+    CU_ASSERT(movie_record(&recorded, frame, joypad) == 0);
+    gb_run_frame(gb);
+  }
+  CU_ASSERT(movie_end(&recorded, FRAMES) == 0);
+  recorded_hash = gb_screen_hash(gb);
+  gb_destroy(gb);
+
+  // Only the changes of input are kept
+  CU_ASSERT(recorded.count > 0);
+  CU_ASSERT(recorded.count < FRAMES / 4);
+  CU_ASSERT(movie_length(&recorded) == FRAMES);
+
+  // The input shows on screen
+  CU_ASSERT(replay(NULL, FRAMES) != recorded_hash);
+}
+
+static void test_replay(void)
+{
+  CU_ASSERT(movie_save(&recorded, MOVIE_PATH) == 0);
+
+  Movie movie;
+  CU_ASSERT(movie_load(&movie, MOVIE_PATH) == 0);
+  CU_ASSERT(movie.count == recorded.count);
+  CU_ASSERT(movie_length(&movie) == FRAMES);
+
+  CU_ASSERT(replay(&movie, movie_length(&movie)) == recorded_hash);
+  movie_free(&movie);
+}
+
+static void test_rejected(void)
+{
+  FILE *file = fopen(MOVIE_PATH, "wb");
+  fwrite("GBMX\x01", 5, 1, file);
+  fclose(file);
+
+  Movie movie;
+  CU_ASSERT(movie_load(&movie, MOVIE_PATH) == -1);
+  CU_ASSERT(movie_load(&movie, "missing.gbmv") == -1);
+  movie_free(&movie);
+  remove(MOVIE_PATH);
+}
+
+static void test_backwards(void)
+{
+  // Frame 10 then frame 5
+  FILE *file = fopen(MOVIE_PATH, "wb");
+  fwrite("GBMV\x01", 5, 1, file);
+  fwrite("\x0A\x00\x00\x00\xEF", 5, 1, file);
+  fwrite("\x05\x00\x00\x00\xFF", 5, 1, file);
+  fclose(file);
+
+  Movie movie;
+  CU_ASSERT(movie_load(&movie, MOVIE_PATH) == -1);
+  CU_ASSERT(movie.count == 0);
+  CU_ASSERT(movie.events == NULL);
+  remove(MOVIE_PATH);
+}
+
+int add_movie_suite(void)
+{
+  CU_pSuite pSuite = CU_add_suite("movie_suite", init_movie_suite, clean_movie_suite);
+  if (NULL == pSuite)
+    return 1;
+
+  if ((NULL == CU_add_test(pSuite, "test of movie recording", test_record))
+    || (NULL == CU_add_test(pSuite, "test of movie replay", test_replay))
+    || (NULL == CU_add_test(pSuite, "test of refused movies", test_rejected))
+    || (NULL == CU_add_test(pSuite, "test of movies going backwards", test_backwards))
+  )
+    return 1;
+  return 0;
+}
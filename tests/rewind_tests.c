@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "gb.h"
+#include "rewind.h"
+#include "state.h"
+#include "helpers.h"
+
+// More frames than a keyframe interval, so the ring holds deltas of two
+// keyframes
+#define FRAMES (REWIND_KEYFRAME_INTERVAL + 20)
+
+static GbContext *machine;
+static size_t state_len;
+static uint8_t *states;     // state after each frame pushed
+static uint8_t *state;
+
+static int init_rewind_suite(void)
+{
+  machine = gb_create("misc/Tetris.gb");
+  state_len = state_size(machine);
+  states = malloc(state_len * FRAMES);
+  state = malloc(state_len);
+  return states == NULL || state == NULL;
+}
+
+static int clean_rewind_suite(void)
+{
+  free(states);
+  free(state);
+  gb_destroy(machine);
+  return 0;
+}
+
+// Run frame `i`. A page of WRAM is scribbled over every frame so no two
+// states are alike.
+static void step(int i)
+{
+  gb_run_frame(machine);
+  for (int j = 0; j < 0x100; j++)
+    write_memory(machine, 0xD000 + j, i * 7 + j * 13);
+}
+
+// Run and push `n` frames, keeping the state of each
+static void record(Rewind *rw, int n)
+{
+  for (int i = 0; i < n; i++)
+  {
+    step(i);
+    rewind_push(rw, machine);
+    state_save(machine, states + i * state_len);
+  }
+}
+
+// The state popped is the one pushed after frame `i`
+static int popped(Rewind *rw, int i)
+{
+  if (rewind_pop(rw, machine) != 0)
+    return 0;
+  state_save(machine, state);
+  return memcmp(state, states + i * state_len, state_len) == 0;
+}
+
+static void test_round_trip(void)
+{
+  Rewind *rw = rewind_new(machine, FRAMES, state_len * FRAMES);
+  CU_ASSERT(rw != NULL);
+  if (!rw)
+    return;
+
+  record(rw, FRAMES);
+  CU_ASSERT(rw->count == FRAMES);
+  // Most of a frame is the same as its keyframe
+  CU_ASSERT(rewind_used(rw) < state_len * FRAMES / 8);
+
+  // Newest first, keyframes and the deltas on them alike
+  for (int i = FRAMES - 1; i >= 0; i--)
+    CU_ASSERT(popped(rw, i));
+  CU_ASSERT(rw->count == 0);
+  CU_ASSERT(rewind_used(rw) == 0);
+  CU_ASSERT(rewind_pop(rw, machine) == -1);
+
+  rewind_free(rw);
+}
+
+static void test_full_frames(void)
+{
+  // Room for fewer frames than a keyframe interval
+  Rewind *rw = rewind_new(machine, 10, state_len * FRAMES);
+  CU_ASSERT(rw != NULL);
+  if (!rw)
+    return;
+
+  record(rw, FRAMES);
+  CU_ASSERT(rw->count > 0);
+  CU_ASSERT(rw->count <= 10);
+  // The oldest entry left is always a keyframe
+  CU_ASSERT(rw->entries[rw->first].key == rw->first_frame);
+
+  uint32_t count = rw->count;
+  for (uint32_t i = 0; i < count && i < FRAMES; i++)
+    CU_ASSERT(popped(rw, FRAMES - 1 - i));
+  CU_ASSERT(rewind_pop(rw, machine) == -1);
+
+  rewind_free(rw);
+}
+
+static void test_full_bytes(void)
+{
+  // Room for a keyframe and some deltas
+  size_t capacity = state_len / 4;
+  Rewind *rw = rewind_new(machine, FRAMES * 4, capacity);
+  CU_ASSERT(rw != NULL);
+  if (!rw)
+    return;
+
+  // Twice over, so the data ring wraps
+  record(rw, FRAMES);
+  record(rw, FRAMES);
+  CU_ASSERT(rw->count > 0);
+  CU_ASSERT(rw->count < FRAMES);
+  CU_ASSERT(rewind_used(rw) <= capacity);
+  CU_ASSERT(rw->entries[rw->first].key == rw->first_frame);
+
+  uint32_t count = rw->count;
+  for (uint32_t i = 0; i < count && i < FRAMES; i++)
+    CU_ASSERT(popped(rw, FRAMES - 1 - i));
+  CU_ASSERT(rewind_pop(rw, machine) == -1);
+
+  rewind_free(rw);
+}
+
+static void test_keyframe_only(void)
+{
+  uint8_t *start = malloc(state_len);
+  state_save(machine, start);
+
+  // Size of the first frames as keyframes, a ring of one keeps only those
+  Rewind *probe = rewind_new(machine, 1, state_len * 2);
+  size_t key_len = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    step(i);
+    rewind_push(probe, machine);
+    size_t len = rewind_used(probe);
+    key_len = len > key_len ? len : key_len;
+  }
+  rewind_free(probe);
+
+  // Room for any of them, not for a keyframe and the delta after it: each
+  // push drops the keyframe before and is kept as a keyframe of its own
+  state_load(machine, start, state_len);
+  Rewind *rw = rewind_new(machine, FRAMES, key_len);
+  record(rw, 3);
+  CU_ASSERT(rw->count == 1);
+  CU_ASSERT(rw->entries[rw->first].key == rw->first_frame);
+  CU_ASSERT(rewind_used(rw) <= key_len);
+  CU_ASSERT(popped(rw, 2));
+  CU_ASSERT(rewind_pop(rw, machine) == -1);
+
+  rewind_free(rw);
+  free(start);
+}
+
+int add_rewind_suite(void)
+{
+  CU_pSuite pSuite = CU_add_suite("rewind_suite", init_rewind_suite, clean_rewind_suite);
+  if (NULL == pSuite)
+    return 1;
+
+  if ((NULL == CU_add_test(pSuite, "test of rewind round trip", test_round_trip))
+    || (NULL == CU_add_test(pSuite, "test of rewind past its frames", test_full_frames))
+    || (NULL == CU_add_test(pSuite, "test of rewind past its bytes", test_full_bytes))
+    || (NULL == CU_add_test(pSuite, "test of rewind with room for a keyframe", test_keyframe_only))
+  )
+    return 1;
+  return 0;
+}
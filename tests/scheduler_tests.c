@@ -0,0 +1,84 @@
+#include "CUnit/Basic.h"
+#include "scheduler.h"
+#include "helpers.h"
+
+static Scheduler s;
+
+static void test_order(void)
+{
+  scheduler_init(&s);
+  CU_ASSERT(s.next == EVENT_NEVER);
+  CU_ASSERT(scheduler_pop(&s, 1000) == -1);
+
+  scheduler_schedule(&s, EVENT_TIMER, 30);
+  scheduler_schedule(&s, EVENT_PPU, 10);
+  scheduler_schedule(&s, EVENT_DIV, 20);
+  scheduler_schedule(&s, EVENT_STOP, 40);
+  CU_ASSERT(s.next == 10);
+
+  // Nothing is due before its deadline
+  CU_ASSERT(scheduler_pop(&s, 9) == -1);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_PPU);
+  CU_ASSERT(s.next == 20);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_DIV);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_TIMER);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_STOP);
+  CU_ASSERT(scheduler_pop(&s, 100) == -1);
+  CU_ASSERT(s.next == EVENT_NEVER);
+}
+
+static void test_reschedule(void)
+{
+  scheduler_init(&s);
+  scheduler_schedule(&s, EVENT_PPU, 10);
+  scheduler_schedule(&s, EVENT_TIMER, 20);
+  scheduler_schedule(&s, EVENT_DIV, 30);
+
+  // Later: the event moves down the heap, it is still queued only once
+  scheduler_schedule(&s, EVENT_PPU, 50);
+  CU_ASSERT(s.size == 3);
+  CU_ASSERT(s.next == 20);
+
+  // Earlier: it moves back to the top
+  scheduler_schedule(&s, EVENT_DIV, 5);
+  CU_ASSERT(s.size == 3);
+  CU_ASSERT(s.next == 5);
+
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_DIV);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_TIMER);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_PPU);
+  CU_ASSERT(scheduler_pop(&s, 100) == -1);
+}
+
+static void test_cancel(void)
+{
+  scheduler_init(&s);
+  scheduler_schedule(&s, EVENT_PPU, 10);
+  scheduler_schedule(&s, EVENT_TIMER, 20);
+  scheduler_schedule(&s, EVENT_DIV, 30);
+
+  scheduler_cancel(&s, EVENT_PPU);
+  CU_ASSERT(s.next == 20);
+  CU_ASSERT(s.deadline[EVENT_PPU] == EVENT_NEVER);
+  scheduler_cancel(&s, EVENT_PPU);
+  CU_ASSERT(s.size == 2);
+
+  scheduler_cancel(&s, EVENT_DIV);
+  CU_ASSERT(s.next == 20);
+  CU_ASSERT(scheduler_pop(&s, 100) == EVENT_TIMER);
+  CU_ASSERT(s.next == EVENT_NEVER);
+}
+
+int add_scheduler_suite(void)
+{
+  CU_pSuite pSuite = CU_add_suite("scheduler_suite", NULL, NULL);
+  if (NULL == pSuite)
+    return 1;
+
+  if ((NULL == CU_add_test(pSuite, "test of event order", test_order))
+    || (NULL == CU_add_test(pSuite, "test of rescheduling", test_reschedule))
+    || (NULL == CU_add_test(pSuite, "test of cancelling", test_cancel))
+  )
+    return 1;
+  return 0;
+}
@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "gb.h"
+#include "helpers.h"
+
+static GbContext *machine;
+static uint8_t *state;
+static size_t state_len;
+
+// What a state must bring back
+typedef struct Snapshot
+{
+  Registers r;
+  My_clock clock;
+  uint8_t memory[0x10000];
+} Snapshot;
+
+static Snapshot before;
+
+static int init_state_suite(void)
+{
+  machine = gb_create("misc/Tetris.gb");
+  state_len = state_size(machine);
+  state = malloc(state_len + 1);
+  return state == NULL;
+}
+
+static int clean_state_suite(void)
+{
+  free(state);
+  gb_destroy(machine);
+  return 0;
+}
+
+static void take(Snapshot *s, const GbContext *gb)
+{
+  s->r = gb->r;
+  s->clock = gb->clock;
+  memcpy(s->memory, gb->mmu.memory, sizeof(s->memory));
+}
+
+static int same(const Snapshot *s, const GbContext *gb)
+{
+  return memcmp(&s->r, &gb->r, sizeof(s->r)) == 0
+    && s->clock.m == gb->clock.m && s->clock.t == gb->clock.t
+    && s->clock.cycles == gb->clock.cycles && s->clock.mode == gb->clock.mode
+    && s->clock.mode_start == gb->clock.mode_start
+    && s->clock.div_start == gb->clock.div_start
+    && s->clock.timer_start == gb->clock.timer_start
+    && s->clock.timer_counter == gb->clock.timer_counter
+    && s->clock.clock_speed == gb->clock.clock_speed
+    && memcmp(s->memory, gb->mmu.memory, sizeof(s->memory)) == 0;
+}
+
+static void test_round_trip(void)
+{
+  for (int i = 0; i < 300; i++)
+    gb_run_frame(machine);
+  CU_ASSERT(state_save(machine, state) == state_len);
+  take(&before, machine);
+
+  for (int i = 0; i < 30; i++)
+    gb_run_frame(machine);
+  machine->r.AF.val ^= 0xFFF0;
+  machine->mmu.memory[0xC123] ^= 0xFF;
+  CU_ASSERT(!same(&before, machine));
+
+  CU_ASSERT(state_load(machine, state, state_len) == 0);
+  CU_ASSERT(same(&before, machine));
+}
+
+static void test_same_run(void)
+{
+  CU_ASSERT(state_save(machine, state) == state_len);
+  for (int i = 0; i < 60; i++)
+    gb_run_frame(machine);
+  uint64_t hash = gb_screen_hash(machine);
+  uint64_t cycles = machine->clock.cycles;
+
+  // Frames run after the load are the same ones again
+  CU_ASSERT(state_load(machine, state, state_len) == 0);
+  for (int i = 0; i < 60; i++)
+    gb_run_frame(machine);
+  CU_ASSERT(gb_screen_hash(machine) == hash);
+  CU_ASSERT(machine->clock.cycles == cycles);
+}
+
+static void test_rejected(void)
+{
+  state_save(machine, state);
+  take(&before, machine);
+
+  CU_ASSERT(state_load(machine, state, state_len - 1) == -1);
+  CU_ASSERT(state_load(machine, state, state_len + 1) == -1);
+  CU_ASSERT(state_load(machine, state, 0) == -1);
+
+  state[0] = 'X';
+  CU_ASSERT(state_load(machine, state, state_len) == -1);
+  state[0] = 'G';
+  state[4] = STATE_VERSION + 1;
+  CU_ASSERT(state_load(machine, state, state_len) == -1);
+  state[4] = STATE_VERSION;
+  state[5] = STATE_DELTA;
+  CU_ASSERT(state_load(machine, state, state_len) == -1);
+  state[5] = STATE_FULL;
+  state[12] ^= 0xFF;  // another cartridge
+  CU_ASSERT(state_load(machine, state, state_len) == -1);
+
+  // Nothing was touched by the refused loads
+  CU_ASSERT(same(&before, machine));
+}
+
+static void test_dirty(void)
+{
+  state_clear_dirty(machine);
+  CU_ASSERT(!machine->mmu.dirty[0xC3]);
+
+  write_memory(machine, 0xC345, machine->mmu.memory[0xC345] + 1);
+  CU_ASSERT(machine->mmu.dirty[0xC3]);
+  CU_ASSERT(!machine->mmu.dirty[0xC2]);
+  CU_ASSERT(!machine->mmu.dirty[0xC4]);
+
+  // Writes to the echo of WRAM land in both pages
+  write_memory(machine, 0xE512, 0x42);
+  CU_ASSERT(machine->mmu.dirty[0xE5]);
+  CU_ASSERT(machine->mmu.dirty[0xC5]);
+
+  // Loading a full state may have changed any page
+  state_save(machine, state);
+  state_clear_dirty(machine);
+  state_load(machine, state, state_len);
+  CU_ASSERT(machine->mmu.dirty[0x00]);
+  CU_ASSERT(machine->mmu.dirty[0xD0]);
+}
+
+// Bring `copy` to where `machine` is through a full state, run `machine`
+// on and return its delta since then in `delta`
+static size_t make_delta(GbContext *copy, uint8_t *delta)
+{
+  state_save(machine, state);
+  CU_ASSERT(state_load(copy, state, state_len) == 0);
+  state_clear_dirty(machine);
+
+  for (int i = 0; i < 10; i++)
+    gb_run_frame(machine);
+  write_memory(machine, 0xC0F0, 0x5A);
+  return state_save_delta(machine, delta);
+}
+
+static void test_delta(void)
+{
+  GbContext *copy = gb_create("misc/Tetris.gb");
+  uint8_t *delta = malloc(state_delta_max(machine));
+
+  size_t len = make_delta(copy, delta);
+  CU_ASSERT(len < state_size(machine));
+  take(&before, machine);
+  CU_ASSERT(!same(&before, copy));
+
+  CU_ASSERT(state_load_delta(copy, delta, len) == 0);
+  CU_ASSERT(same(&before, copy));
+
+  free(delta);
+  gb_destroy(copy);
+}
+
+static void test_delta_rejected(void)
+{
+  GbContext *copy = gb_create("misc/Tetris.gb");
+  uint8_t *delta = malloc(state_delta_max(machine) + 1);
+
+  size_t len = make_delta(copy, delta);
+  take(&before, copy);
+
+  // Cut anywhere, in the fields, the page count or a page
+  CU_ASSERT(state_load_delta(copy, delta, len - 1) == -1);
+  CU_ASSERT(state_load_delta(copy, delta, len - 0x100) == -1);
+  CU_ASSERT(state_load_delta(copy, delta, 40) == -1);
+  CU_ASSERT(state_load_delta(copy, delta, 17) == -1);
+  CU_ASSERT(state_load_delta(copy, delta, 0) == -1);
+  CU_ASSERT(state_load_delta(copy, delta, len + 1) == -1);
+
+  // A full state is not a delta
+  CU_ASSERT(state_load_delta(copy, state, state_len) == -1);
+
+  // Page numbers past the RAM
+  uint8_t byte = delta[len - 0x102];
+  delta[len - 0x102] = 0xFF;
+  delta[len - 0x101] = 0xFF;
+  CU_ASSERT(state_load_delta(copy, delta, len) == -1);
+  delta[len - 0x102] = byte;
+
+  CU_ASSERT(same(&before, copy));
+
+  free(delta);
+  gb_destroy(copy);
+}
+
+int add_state_suite(void)
+{
+  CU_pSuite pSuite = CU_add_suite("state_suite", init_state_suite, clean_state_suite);
+  if (NULL == pSuite)
+    return 1;
+
+  if ((NULL == CU_add_test(pSuite, "test of state round trip", test_round_trip))
+    || (NULL == CU_add_test(pSuite, "test of running on from a state", test_same_run))
+    || (NULL == CU_add_test(pSuite, "test of refused states", test_rejected))
+    || (NULL == CU_add_test(pSuite, "test of dirty pages", test_dirty))
+    || (NULL == CU_add_test(pSuite, "test of deltas", test_delta))
+    || (NULL == CU_add_test(pSuite, "test of refused deltas", test_delta_rejected))
+  )
+    return 1;
+  return 0;
+}
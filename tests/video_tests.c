@@ -0,0 +1,127 @@
+#include <string.h>
+#include "CUnit/Basic.h"
+#include "gb.h"
+#include "vram.h"
+#include "helpers.h"
+
+static GbContext *machine;
+
+static int init_video_suite(void)
+{
+  machine = gb_create("misc/Tetris.gb");
+  // On the title screen, the background is drawn
+  for (int i = 0; i < 400; i++)
+    gb_run_frame(machine);
+  return 0;
+}
+
+static int clean_video_suite(void)
+{
+  gb_destroy(machine);
+  return 0;
+}
+
+// Draw the first line of map 0x9800 with the tiles at 0x8000, unscrolled.
+// Returns the tile of its first cell.
+static int draw_first_line(void)
+{
+  machine->mmu.memory[0xFF40] = 0x91;
+  machine->mmu.memory[0xFF42] = 0;
+  machine->mmu.memory[0xFF43] = 0;
+  machine->mmu.memory[0xFF44] = 0;
+  print_tiles(machine, machine->framebuffer);
+  return machine->mmu.memory[0x9800];
+}
+
+static void test_tile_write(void)
+{
+  int tile = draw_first_line();
+  uint32_t version = machine->tiles.version[tile];
+  CU_ASSERT(!machine->tiles.stale[tile]);
+
+  // A write to tile data only flags the tile, it is decoded when drawn
+  uint16_t addr = 0x8000 + tile * 16;
+  write_memory(machine, addr, ~machine->mmu.memory[addr]);
+  CU_ASSERT(machine->tiles.stale[tile]);
+  CU_ASSERT(!machine->tiles.stale[(tile + 1) % 384]);
+  CU_ASSERT(machine->tiles.version[tile] == version);
+
+  draw_first_line();
+  CU_ASSERT(!machine->tiles.stale[tile]);
+  CU_ASSERT(machine->tiles.version[tile] == version + 1);
+  uint8_t low = machine->mmu.memory[addr];
+  uint8_t high = machine->mmu.memory[addr + 1];
+  CU_ASSERT(machine->tiles.pixels[tile][0][0] == ((low >> 7) | ((high >> 7) << 1)));
+  CU_ASSERT(machine->tiles.pixels[tile][0][7] == ((low & 1) | ((high & 1) << 1)));
+
+  // Neither a map write nor drawing again decodes it once more
+  write_memory(machine, 0x9800 + 32, machine->mmu.memory[0x9800 + 32]);
+  draw_first_line();
+  CU_ASSERT(machine->tiles.version[tile] == version + 1);
+}
+
+static void test_bgp_write(void)
+{
+  int tile = draw_first_line();
+  CU_ASSERT(machine->bg.cell_version[0][0] == machine->tiles.version[tile]);
+
+  // The same value again changes no colour, nothing is drawn again
+  write_memory(machine, 0xFF47, machine->mmu.memory[0xFF47]);
+  CU_ASSERT(machine->bg.cell_version[0][0] == machine->tiles.version[tile]);
+
+  // Shades in reverse, every cell of both maps is drawn again
+  uint8_t bgp = machine->mmu.memory[0xFF47];
+  write_memory(machine, 0xFF47, ~bgp);
+  CU_ASSERT(machine->bg.cell_version[0][0] == 0);
+  CU_ASSERT(machine->bg.cell_version[0][1023] == 0);
+  CU_ASSERT(machine->bg.cell_version[1][0] == 0);
+  for (int c = 0; c < 4; c++)
+    CU_ASSERT(machine->palettes.bgp_shade[c] == 3 - ((bgp >> (c * 2)) & 3));
+
+  draw_first_line();
+  CU_ASSERT(machine->bg.cell_version[0][0] == machine->tiles.version[tile]);
+  for (int x = 0; x < 8; x++)
+  {
+    uint8_t colour = machine->tiles.pixels[tile][0][x];
+    CU_ASSERT(machine->bg.shade[0][0][x] == machine->palettes.bgp_shade[colour]);
+    CU_ASSERT(machine->shades[x] == machine->palettes.bgp_shade[colour]);
+    CU_ASSERT(memcmp(&machine->framebuffer[x * 4], &machine->palettes.bgp[colour], 4) == 0);
+  }
+
+  write_memory(machine, 0xFF47, bgp);
+}
+
+static void test_bios_bgp_write(void)
+{
+  int tile = draw_first_line();
+  uint8_t bgp = machine->mmu.memory[0xFF47];
+
+  // The boot ROM sets BGP while it is mapped
+  machine->mmu.BIOS_MODE = 1;
+  write_memory(machine, 0xFF47, ~bgp);
+  machine->mmu.BIOS_MODE = 0;
+  CU_ASSERT(machine->palettes.stale);
+
+  draw_first_line();
+  CU_ASSERT(!machine->palettes.stale);
+  for (int c = 0; c < 4; c++)
+    CU_ASSERT(machine->palettes.bgp_shade[c] == 3 - ((bgp >> (c * 2)) & 3));
+  uint8_t colour = machine->tiles.pixels[tile][0][0];
+  CU_ASSERT(machine->shades[0] == machine->palettes.bgp_shade[colour]);
+
+  write_memory(machine, 0xFF47, bgp);
+}
+
+int add_video_suite(void)
+{
+  CU_pSuite pSuite = CU_add_suite("video_suite", init_video_suite, clean_video_suite);
+  if (NULL == pSuite)
+    return 1;
+
+  if ((NULL == CU_add_test(pSuite, "test of tile data writes", test_tile_write))
+    || (NULL == CU_add_test(pSuite, "test of BGP writes", test_bgp_write))
+    || (NULL == CU_add_test(pSuite, "test of BGP writes under the BIOS", test_bios_bgp_write))
+  )
+    return 1;
+  return 0;
+}